@@ -0,0 +1,200 @@
+#ifndef EMP_SH2PC_BENCH_H__
+#define EMP_SH2PC_BENCH_H__
+#include "emp-sh2pc/emp-sh2pc.h"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace emp {
+
+struct BenchResult {
+	std::string name;
+	std::string unit;
+	double mean, stddev;
+	int runs;
+
+	// relative standard error of the mean
+	double rse() const {
+		return runs > 1 and mean != 0 ? stddev/std::sqrt((double)runs)/std::fabs(mean) : 0;
+	}
+};
+
+/* One benchmark binary: both parties run the same sequence of measure()
+ * calls over io. Every measurement is repeated until the relative standard
+ * error of its mean drops below max_rse (after at least min_runs) or
+ * max_runs is reached; ALICE decides and tells BOB, so both run the same
+ * number of times. ALICE writes the results. */
+class Bench { public:
+	std::string bench;
+	NetIO * io = nullptr;
+	int party = ALICE;
+	int min_runs = 5, max_runs = 50;
+	double max_rse = 0.02;
+	bool csv = false;
+	std::string out;	// empty for stdout
+	std::vector<BenchResult> results;
+
+	// both parties return once both got here
+	void sync() {
+		char c = 0;
+		if(party == ALICE) {
+			io->send_data(&c, 1);
+			io->flush();
+			io->recv_data(&c, 1);
+		} else {
+			io->recv_data(&c, 1);
+			io->send_data(&c, 1);
+			io->flush();
+		}
+	}
+
+	/* Times run() on both parties and records work per second of it, e.g.
+	 * work = AND gates garbled by one run for unit "AND/s". */
+	template<typename F>
+	void measure(const std::string & name, const std::string & unit, double work, F run) {
+		std::vector<double> samples;
+		bool more = true;
+		while(more) {
+			sync();
+			auto start = clock_start();
+			run();
+			io->flush();
+			sync();
+			samples.push_back(work/time_from(start)*1e6);
+			if(party == ALICE) {
+				more = !stable(samples);
+				io->send_data(&more, 1);
+				io->flush();
+			} else io->recv_data(&more, 1);
+		}
+		double mean = 0, var = 0;
+		for(double s : samples)
+			mean += s;
+		mean /= samples.size();
+		for(double s : samples)
+			var += (s - mean)*(s - mean);
+		if(samples.size() > 1)
+			var /= samples.size() - 1;
+		results.push_back(BenchResult{name, unit, mean, std::sqrt(var), (int)samples.size()});
+	}
+
+	// A value that does not need repeating, such as AND gates per operation
+	void report(const std::string & name, const std::string & unit, double value) {
+		results.push_back(BenchResult{name, unit, value, 0, 1});
+	}
+
+	bool stable(const std::vector<double> & samples) const {
+		int n = samples.size();
+		if(n >= max_runs)
+			return true;
+		if(n < min_runs)
+			return false;
+		double mean = 0, var = 0;
+		for(double s : samples)
+			mean += s;
+		mean /= n;
+		for(double s : samples)
+			var += (s - mean)*(s - mean);
+		var /= n - 1;
+		return std::sqrt(var/n) <= max_rse*std::fabs(mean);
+	}
+
+	std::string format() const {
+		std::ostringstream s;
+		if(csv) {
+			s << "bench,name,unit,mean,stddev,rse,runs\n";
+			for(const auto & r : results)
+				s << bench << "," << r.name << "," << r.unit << "," << r.mean << "," << r.stddev << "," << r.rse() << "," << r.runs << "\n";
+		} else {
+			s << "{\"bench\": \"" << bench << "\", \"results\": [";
+			for(size_t i = 0; i < results.size(); ++i) {
+				const BenchResult & r = results[i];
+				s << (i == 0 ? "\n" : ",\n") << "  {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit
+					<< "\", \"mean\": " << r.mean << ", \"stddev\": " << r.stddev << ", \"rse\": " << r.rse()
+					<< ", \"runs\": " << r.runs << "}";
+			}
+			s << "\n]}\n";
+		}
+		return s.str();
+	}
+
+	void write() const {
+		if(party != ALICE)
+			return;
+		if(out.empty())
+			std::cout << format();
+		else {
+			std::ofstream f(out);
+			f << format();
+		}
+	}
+};
+
+/* Entry point of every benchmark. With "<party> <port>" as the first two
+ * arguments it runs that party only, as the tests do; otherwise it forks and
+ * runs both parties over localhost. Options:
+ *   --port <p>  --csv  --out <file>  --min-runs <n>  --max-runs <n>  --rse <x> */
+template<typename F>
+inline int bench_main(const std::string & name, int argc, char ** argv, F run) {
+	Bench b;
+	b.bench = name;
+	int port = 12345, party = 0;
+	int first = 1;
+	if(argc > 2 and (std::string(argv[1]) == "1" or std::string(argv[1]) == "2")) {
+		party = atoi(argv[1]);
+		port = atoi(argv[2]);
+		first = 3;
+	}
+	for(int i = first; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if(arg == "--csv")
+			b.csv = true;
+		else if(arg == "--json")
+			b.csv = false;
+		else if(arg == "--port" and has_value)
+			port = atoi(argv[++i]);
+		else if(arg == "--out" and has_value)
+			b.out = argv[++i];
+		else if(arg == "--min-runs" and has_value)
+			b.min_runs = std::max(2, atoi(argv[++i]));
+		else if(arg == "--max-runs" and has_value)
+			b.max_runs = atoi(argv[++i]);
+		else if(arg == "--rse" and has_value)
+			b.max_rse = atof(argv[++i]);
+		else {
+			std::cerr << "usage: " << argv[0] << " [<party> <port>] [--port p] [--csv] [--out file]"
+				<< " [--min-runs n] [--max-runs n] [--rse x]" << std::endl;
+			return 1;
+		}
+	}
+
+	pid_t child = -1;
+	if(party == 0) {
+		child = fork();
+		if(child < 0)
+			error("fork failed\n");
+		party = child == 0 ? BOB : ALICE;
+	}
+	b.party = party;
+	b.io = new NetIO(party == ALICE ? nullptr : "127.0.0.1", port, true);
+	run(b);
+	b.write();
+	delete b.io;
+	if(child == 0)
+		exit(0);
+	if(child > 0) {
+		int status = 0;
+		waitpid(child, &status, 0);
+		return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+	}
+	return 0;
+}
+
+}
+#endif
@@ -0,0 +1,44 @@
+#include "bench.h"
+using namespace emp;
+using namespace std;
+const string circuit_file_location = macro_xstr(EMP_CIRCUIT_PATH);
+
+int64_t count_and(const BristolFormat & cf) {
+	int64_t res = 0;
+	for(int i = 0; i < cf.num_gate; ++i)
+		if(cf.gates[4*i+3] == AND_GATE)
+			++res;
+	return res;
+}
+
+// Bristol circuits per second, one at a time and AES also 8 instances per gate walk
+int main(int argc, char** argv) {
+	return bench_main("bristol", argc, argv, [](Bench & b) {
+		setup_semi_honest(b.io, b.party);
+		for(string name : {"AES-non-expanded", "sha-256"}) {
+			string file = circuit_file_location + "/bristol_format/" + name + ".txt";
+			BristolFormat cf(file.c_str());
+			const int runs = name == "sha-256" ? 24 : 96;	// multiples of the batch width
+			Integer x(cf.n1, 2, ALICE), y(cf.n2, 3, BOB), z(cf.n3, 0, PUBLIC);
+			b.report(name + "/and", "AND/circuit", count_and(cf));
+			b.measure(name, "circuit/s", runs, [&]() {
+				for(int i = 0; i < runs; ++i)
+					cf.compute((block *)z.bits.data(), (block *)x.bits.data(), (block *)y.bits.data());
+			});
+			if(name != "AES-non-expanded")
+				continue;
+			const int width = 8;
+			vector<block> in1(width*cf.n1), in2(width*cf.n2), out(width*cf.n3);
+			for(int k = 0; k < width; ++k) {
+				memcpy(in1.data() + k*cf.n1, x.bits.data(), cf.n1*sizeof(block));
+				memcpy(in2.data() + k*cf.n2, y.bits.data(), cf.n2*sizeof(block));
+			}
+			BristolBatch<NetIO> batch(&cf, b.io, width);
+			b.measure(name + "/batch=8", "circuit/s", runs, [&]() {
+				for(int i = 0; i < runs; i += width)
+					batch.compute(out.data(), in1.data(), in2.data());
+			});
+		}
+		finalize_semi_honest();
+	});
+}
@@ -0,0 +1,30 @@
+#include "bench.h"
+using namespace emp;
+using namespace std;
+
+const char * ot_name[] = {"iknp", "ferret"};
+
+// BOB's input bits per second for every OT backend and COT batch size
+int main(int argc, char** argv) {
+	return bench_main("feed", argc, argv, [](Bench & b) {
+		const int64_t n = 1<<20;
+		const int chunk = 1024;
+		vector<block> label(chunk);
+		bool * in = new bool[chunk];
+		PRG prg(fix_key);
+		prg.random_bool(in, chunk);
+		for(int ot_type : {IKNP_OT, FERRET_OT}) {
+			SemiHonestParty<NetIO> * ctx = setup_semi_honest(b.io, b.party, 1024*16, ot_type);
+			for(int batch_size : {1<<12, 1<<14, 1<<16, 1<<18}) {
+				ctx->set_batch_size(batch_size);
+				string name = string(ot_name[ot_type]) + "/batch=" + to_string(batch_size);
+				b.measure(name, "bit/s", n, [&]() {
+					for(int64_t i = 0; i < n; i += chunk)
+						ctx->feed(label.data(), BOB, in, chunk);
+				});
+			}
+			finalize_semi_honest();
+		}
+		delete[] in;
+	});
+}
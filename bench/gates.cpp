@@ -0,0 +1,25 @@
+#include "bench.h"
+using namespace emp;
+using namespace std;
+
+// Raw HalfGateGen/HalfGateEva throughput on independent gates
+int main(int argc, char** argv) {
+	return bench_main("gates", argc, argv, [](Bench & b) {
+		setup_semi_honest(b.io, b.party);
+		const int64_t n = 1<<20;
+		vector<block> in(n), out(n);
+		PRG prg(fix_key);
+		prg.random_block(in.data(), n);
+		CircuitExecution * circ = CircuitExecution::circ_exec;
+
+		b.measure("and", "AND/s", n, [&]() {
+			for(int64_t i = 0; i < n; ++i)
+				out[i] = circ->and_gate(in[i], in[i ^ 1]);
+		});
+		b.measure("xor", "XOR/s", n, [&]() {
+			for(int64_t i = 0; i < n; ++i)
+				out[i] = circ->xor_gate(in[i], in[i ^ 1]);
+		});
+		finalize_semi_honest();
+	});
+}
@@ -0,0 +1,34 @@
+#include "bench.h"
+using namespace emp;
+using namespace std;
+
+/* Cost of Integer operations per width: AND gates per operation, and
+ * operations per second over enough repetitions for about 2^20 ANDs. */
+template<typename Op>
+void bench_op(Bench & b, const string & name, int width, Op op) {
+	Integer x(width, 12345, ALICE), y(width, 678, BOB);
+	uint64_t num_and = CircuitExecution::circ_exec->num_and();
+	op(x, y);
+	num_and = CircuitExecution::circ_exec->num_and() - num_and;
+	int reps = (int)max<uint64_t>(1, (1<<20)/max<uint64_t>(1, num_and));
+	string id = name + "/width=" + to_string(width);
+	b.report(id, "AND/op", num_and);
+	b.measure(id, "op/s", reps, [&]() {
+		for(int i = 0; i < reps; ++i)
+			op(x, y);
+	});
+}
+
+int main(int argc, char** argv) {
+	return bench_main("integer", argc, argv, [](Bench & b) {
+		setup_semi_honest(b.io, b.party);
+		for(int width : {8, 16, 32, 64, 128}) {
+			bench_op(b, "add", width, [](const Integer & x, const Integer & y) { return x + y; });
+			bench_op(b, "mul", width, [](const Integer & x, const Integer & y) { return x * y; });
+			bench_op(b, "div", width, [](const Integer & x, const Integer & y) { return x / y; });
+			bench_op(b, "lt", width, [](const Integer & x, const Integer & y) { return x < y; });
+			bench_op(b, "eq", width, [](const Integer & x, const Integer & y) { return x == y; });
+		}
+		finalize_semi_honest();
+	});
+}
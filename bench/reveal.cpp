@@ -0,0 +1,32 @@
+#include "bench.h"
+using namespace emp;
+using namespace std;
+
+// Opened bits per second, by the number of bits per reveal() call
+int main(int argc, char** argv) {
+	return bench_main("reveal", argc, argv, [](Bench & b) {
+		setup_semi_honest(b.io, b.party);
+		const int64_t n = 1<<20;
+		vector<Bit> bits(n);
+		bool * in = new bool[n], * out = new bool[n];
+		PRG prg(fix_key);
+		prg.random_bool(in, n);
+		ProtocolExecution::prot_exec->feed((block *)bits.data(), ALICE, in, n);
+		for(int chunk : {32, 1024, 1<<16}) {
+			for(int party : {PUBLIC, BOB}) {
+				string name = string(party == PUBLIC ? "public" : "bob") + "/chunk=" + to_string(chunk);
+				b.measure(name, "bit/s", n, [&]() {
+					for(int64_t i = 0; i < n; i += chunk)
+						ProtocolExecution::prot_exec->reveal(out + i, party, (block *)bits.data() + i, chunk);
+				});
+			}
+		}
+		if(b.party == BOB)
+			for(int64_t i = 0; i < n; ++i)
+				if(out[i] != in[i])
+					error("reveal error!");
+		delete[] in;
+		delete[] out;
+		finalize_semi_honest();
+	});
+}
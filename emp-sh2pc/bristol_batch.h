@@ -0,0 +1,170 @@
+#ifndef EMP_BRISTOL_BATCH_H__
+#define EMP_BRISTOL_BATCH_H__
+#include "emp-tool/emp-tool.h"
+#include "emp-sh2pc/sh_party.h"
+#include <vector>
+
+namespace emp {
+
+/* Half-gates over arrays of independent AND gates, outside HalfGateGen/Eva,
+ * for engines that batch or split their AND gates. Gate k hashes with tweaks
+ * 2(gid+k) and 2(gid+k)+1 through H(x, i) = pi(pi(x) ^ i) ^ pi(x), the TCCR
+ * hash of Guo et al., with pi AES under the key of the party (see
+ * SemiHonestParty::gate_key), and every AES round runs over all blocks of the
+ * array so AES-NI pipelines them. */
+
+// x[j] = H(x[j], tweak[j]) for n blocks, using p as scratch
+inline void tccr_blocks(block * x, const block * tweak, block * p, int n, const AES_KEY * key) {
+	AES_ecb_encrypt_blks(x, n, key);
+	for(int j = 0; j < n; ++j)
+		p[j] = x[j] ^ tweak[j];
+	AES_ecb_encrypt_blks(p, n, key);
+	for(int j = 0; j < n; ++j)
+		x[j] = x[j] ^ p[j];
+}
+
+// ALICE: zero labels c[k] and tables (2 blocks per gate); scratch of 12n blocks
+inline void halfgate_garble(block * c, block * table, const block * a, const block * b, int n, const block & delta, uint64_t gid, block * scratch, const AES_KEY * key) {
+	block * h = scratch, * t = h + 4*n, * p = h + 8*n;
+	for(int k = 0; k < n; ++k) {
+		h[4*k] = a[k];
+		h[4*k+1] = a[k] ^ delta;
+		h[4*k+2] = b[k];
+		h[4*k+3] = b[k] ^ delta;
+		t[4*k] = t[4*k+1] = makeBlock(0, 2*(gid + k));
+		t[4*k+2] = t[4*k+3] = makeBlock(0, 2*(gid + k) + 1);
+	}
+	tccr_blocks(h, t, p, 4*n, key);
+	for(int k = 0; k < n; ++k) {
+		bool pa = getLSB(a[k]), pb = getLSB(b[k]);
+		block tg = h[4*k] ^ h[4*k+1], te = h[4*k+2] ^ h[4*k+3] ^ a[k];
+		if(pb)
+			tg = tg ^ delta;
+		block wg = h[4*k], we = h[4*k+2];
+		if(pa)
+			wg = wg ^ tg;
+		if(pb)
+			we = we ^ te ^ a[k];
+		c[k] = wg ^ we;
+		table[2*k] = tg;
+		table[2*k+1] = te;
+	}
+}
+
+// BOB: labels c[k] from the tables of halfgate_garble; scratch of 6n blocks
+inline void halfgate_eval(block * c, const block * table, const block * a, const block * b, int n, uint64_t gid, block * scratch, const AES_KEY * key) {
+	block * h = scratch, * t = h + 2*n, * p = h + 4*n;
+	for(int k = 0; k < n; ++k) {
+		h[2*k] = a[k];
+		h[2*k+1] = b[k];
+		t[2*k] = makeBlock(0, 2*(gid + k));
+		t[2*k+1] = makeBlock(0, 2*(gid + k) + 1);
+	}
+	tccr_blocks(h, t, p, 2*n, key);
+	for(int k = 0; k < n; ++k) {
+		block wg = h[2*k], we = h[2*k+1];
+		if(getLSB(a[k]))
+			wg = wg ^ table[2*k];
+		if(getLSB(b[k]))
+			we = we ^ table[2*k+1] ^ a[k];
+		c[k] = wg ^ we;
+	}
+}
+
+/* Garbles or evaluates one Bristol circuit on width instances at once. The
+ * gate list is walked once per batch and every gate is applied to all
+ * instances before the next one, with the width labels of a wire adjacent in
+ * memory. The half-gates of all instances of an AND gate (4*width AES calls on
+ * ALICE, 2*width on BOB) are hashed together, so AES-NI pipelines them instead
+ * of waiting on one block at a time.
+ *
+ * Uses the delta and public labels of the current HalfGateGen/HalfGateEva, so
+ * labels move freely between batches and ordinary Integer/Bit code; both
+ * parties must call compute() in the same order. Gate ids come from the
+ * current SemiHonestParty, shared with every other batch and engine. */
+template<typename IO>
+class BristolBatch { public:
+	BristolFormat * cf;
+	IO * io;
+	SemiHonestParty<IO> * ctx;
+	int party, width;
+	block delta, one;
+	uint64_t ands_per_run = 0;
+	uint64_t gid = 0, gid_begin = 0, gid_end = 0;	// gate ids of the last compute()
+	uint64_t num_and = 0;
+
+	std::vector<block> wire;	// wire[w*width + k]: wire w of instance k
+	std::vector<block> scratch;
+	std::vector<block> table;
+
+	BristolBatch(BristolFormat * cf, IO * io, int width) : cf(cf), io(io), width(width) {
+		ctx = dynamic_cast<SemiHonestParty<IO>*>(ProtocolExecution::prot_exec);
+		if(ctx == nullptr)
+			error("BristolBatch needs a SemiHonestParty\n");
+		party = ctx->cur_party;
+		for(int i = 0; i < cf->num_gate; ++i)
+			if(cf->gates[4*i+3] == AND_GATE)
+				++ands_per_run;
+		if(party == ALICE)
+			delta = ((HalfGateGen<IO>*)CircuitExecution::circ_exec)->delta;
+		one = CircuitExecution::circ_exec->public_label(true);
+		wire.resize((size_t)cf->num_wire * width);
+		scratch.resize(12*width);
+		table.resize(2*width);
+	}
+
+	/* Instance k reads in1 + k*n1, in2 + k*n2 and writes out + k*n3, as
+	 * BristolFormat::compute does for a single instance. */
+	void compute(block * out, const block * in1, const block * in2) {
+		flush_inputs();
+		gid = gid_begin = ctx->reserve_gate_ids(ands_per_run*width);
+		gid_end = gid_begin + ands_per_run*width;
+		int n1 = cf->n1, n2 = cf->n2, n3 = cf->n3;
+		block * w = wire.data();
+		for(int k = 0; k < width; ++k) {
+			for(int i = 0; i < n1; ++i)
+				w[i*width + k] = in1[k*n1 + i];
+			for(int i = 0; i < n2; ++i)
+				w[(n1 + i)*width + k] = in2[k*n2 + i];
+		}
+		const int * g = cf->gates.data();
+		for(int i = 0; i < cf->num_gate; ++i, g += 4) {
+			block * a = w + (size_t)g[0]*width, * b = w + (size_t)g[1]*width, * c = w + (size_t)g[2]*width;
+			if(g[3] == AND_GATE) {
+				if(party == ALICE)
+					garble_and(c, a, b);
+				else eval_and(c, a, b);
+			} else if(g[3] == XOR_GATE) {
+				for(int k = 0; k < width; ++k)
+					c[k] = a[k] ^ b[k];
+				ctx->counted.num_xor += width;
+			} else {
+				for(int k = 0; k < width; ++k)
+					c[k] = a[k] ^ one;
+			}
+		}
+		int first = cf->num_wire - n3;
+		for(int k = 0; k < width; ++k)
+			for(int i = 0; i < n3; ++i)
+				out[k*n3 + i] = w[(first + i)*width + k];
+	}
+
+	void garble_and(block * c, const block * a, const block * b) {
+		halfgate_garble(c, table.data(), a, b, width, delta, gid, scratch.data(), &ctx->gate_key);
+		io->send_block(table.data(), 2*width);
+		gid += width;
+		num_and += width;
+		ctx->counted.num_and += width;
+	}
+
+	void eval_and(block * c, const block * a, const block * b) {
+		io->recv_block(table.data(), 2*width);
+		halfgate_eval(c, table.data(), a, b, width, gid, scratch.data(), &ctx->gate_key);
+		gid += width;
+		num_and += width;
+		ctx->counted.num_and += width;
+	}
+};
+
+}
+#endif
@@ -0,0 +1,327 @@
+#ifndef EMP_BRISTOL_COMPILED_H__
+#define EMP_BRISTOL_COMPILED_H__
+#include "emp-tool/emp-tool.h"
+#include "emp-sh2pc/bristol_batch.h"
+#include "emp-sh2pc/wire_slots.h"
+#include <fstream>
+#include <future>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace emp {
+
+/* A Bristol circuit precompiled into a binary file that is memory-mapped as
+ * is, so loading it parses nothing. Gates are grouped into levels: a level
+ * starts with AND gates whose inputs all come from earlier levels, followed by
+ * the XOR/NOT gates that depend on them, in file order.
+ * Gates name label slots rather than wires: a slot is reused once the wire in
+ * it is dead, so garbling holds num_slot labels, the circuit's maximum live
+ * width, instead of num_wire. Inputs take the first n1+n2 slots and outputs
+ * the last n3. */
+class CompiledCircuit { public:
+	struct Header {
+		uint64_t magic;
+		uint64_t version;
+		int64_t n1, n2, n3;
+		int64_t num_wire;
+		int64_t num_gate;
+		int64_t num_and;
+		int64_t num_level;
+		int64_t num_slot;
+	};
+	// files without a version field carry the old magic 0x74697563726963
+	static const uint64_t MAGIC = 0x7674697563726963ULL;
+	static const uint64_t VERSION = 1;	// bumped whenever the layout changes
+
+	Header * header = nullptr;
+	const uint32_t * gates = nullptr;	// in0, in1, out slots and type per gate
+	const uint64_t * level = nullptr;	// first gate of every level, and num_gate
+	const uint64_t * level_and = nullptr;	// AND gates at the start of every level
+	size_t file_size = 0;
+
+	static size_t size_of(int64_t num_gate, int64_t num_level) {
+		return sizeof(Header) + 4*num_gate*sizeof(uint32_t)
+			+ (2*num_level + 1)*sizeof(uint64_t);
+	}
+
+	CompiledCircuit(const char * file) {
+		struct stat st;
+		if(stat(file, &st) != 0 or (size_t)st.st_size < sizeof(Header))
+			error("cannot open compiled circuit\n");
+		int fd = open(file, O_RDONLY);
+		if(fd < 0)
+			error("cannot open compiled circuit\n");
+		void * ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if(ptr == MAP_FAILED)
+			error("cannot map compiled circuit\n");
+		file_size = st.st_size;
+		header = (Header *)ptr;
+		if(header->magic != MAGIC)
+			error("invalid compiled circuit\n");
+		if(header->version != VERSION)
+			error("compiled circuit of another version, compile it again\n");
+		const Header * h = header;
+		if(h->num_gate < 0 or h->num_level < 0 or (uint64_t)h->num_gate > file_size/16
+				or (uint64_t)h->num_level > file_size/16
+				or size_of(h->num_gate, h->num_level) != file_size)
+			error("invalid compiled circuit\n");
+		gates = (const uint32_t *)(header + 1);
+		level = (const uint64_t *)(gates + 4*header->num_gate);
+		level_and = level + header->num_level + 1;
+		validate();
+	}
+
+	/* The engines index labels by the slots and levels of the file without
+	 * checks, so a malformed file is rejected here instead. */
+	void validate() const {
+		const Header * h = header;
+		if(h->n1 < 0 or h->n2 < 0 or h->n3 < 0 or h->num_slot > UINT32_MAX
+				or h->n1 + h->n2 > h->num_slot or h->n3 > h->num_slot)
+			error("compiled circuit: bad input or output counts\n");
+		if(h->num_level == 0 ? h->num_gate != 0 : level[0] != 0 or level[h->num_level] != (uint64_t)h->num_gate)
+			error("compiled circuit: bad levels\n");
+		uint64_t ands = 0;
+		for(int64_t l = 0; l < h->num_level; ++l) {
+			if(level[l] > level[l+1] or level_and[l] > level[l+1] - level[l])
+				error("compiled circuit: bad levels\n");
+			ands += level_and[l];
+			for(uint64_t i = level[l]; i < level[l+1]; ++i) {
+				const uint32_t * g = gates + 4*i;
+				uint32_t type = i < level[l] + level_and[l] ? AND_GATE : g[3] == XOR_GATE ? XOR_GATE : NOT_GATE;
+				if(g[3] != type or g[0] >= h->num_slot or g[1] >= h->num_slot or g[2] >= h->num_slot)
+					error("compiled circuit: gate slot out of range\n");
+			}
+		}
+		if(ands != (uint64_t)h->num_and)
+			error("compiled circuit: AND count does not match the levels\n");
+	}
+
+	~CompiledCircuit() {
+		munmap(header, file_size);
+	}
+
+	static void compile(BristolFormat * cf, const char * file) {
+		int64_t G = cf->num_gate, W = cf->num_wire, num_level = 1;
+		std::vector<int64_t> wire_level(W, 0), gate_level(G);
+		for(int64_t i = 0; i < G; ++i) {
+			const int * g = cf->gates.data() + 4*i;
+			int64_t lv = wire_level[g[0]];
+			if(g[3] == XOR_GATE or g[3] == AND_GATE)
+				lv = std::max(lv, wire_level[g[1]]);
+			if(g[3] == AND_GATE)
+				++lv;
+			wire_level[g[2]] = gate_level[i] = lv;
+			num_level = std::max(num_level, lv + 1);
+		}
+
+		std::vector<std::vector<int64_t>> ands(num_level), others(num_level);
+		for(int64_t i = 0; i < G; ++i)
+			(cf->gates[4*i+3] == AND_GATE ? ands : others)[gate_level[i]].push_back(i);
+
+		Header h = {MAGIC, VERSION, cf->n1, cf->n2, cf->n3, W, G, 0, num_level, 0};
+		std::vector<uint32_t> gate_out, last(W);
+		std::vector<uint64_t> first(num_level + 1), and_count(num_level);
+		for(int64_t w = 0; w < W; ++w)
+			last[w] = 0;
+		for(int64_t l = 0; l < num_level; ++l) {
+			first[l] = gate_out.size()/4;
+			and_count[l] = ands[l].size();
+			h.num_and += ands[l].size();
+			for(int pass = 0; pass < 2; ++pass)
+				for(int64_t i : pass == 0 ? ands[l] : others[l]) {
+					const int * g = cf->gates.data() + 4*i;
+					uint32_t idx = gate_out.size()/4;
+					bool binary = g[3] == XOR_GATE or g[3] == AND_GATE;
+					gate_out.push_back(g[0]);
+					gate_out.push_back(binary ? g[1] : g[0]);
+					gate_out.push_back(g[2]);
+					gate_out.push_back(g[3] == AND_GATE ? AND_GATE : binary ? XOR_GATE : NOT_GATE);
+					last[g[0]] = idx;
+					if(binary)
+						last[g[1]] = idx;
+					last[g[2]] = idx;
+				}
+		}
+		first[num_level] = G;
+		for(int64_t w = W - cf->n3; w < W; ++w)
+			last[w] = G;
+		assign_slots(cf, &h, gate_out, first, and_count, last);
+
+		std::ofstream out(file, std::ios::binary | std::ios::trunc);
+		out.write((char *)&h, sizeof(Header));
+		out.write((char *)gate_out.data(), gate_out.size()*sizeof(uint32_t));
+		out.write((char *)first.data(), first.size()*sizeof(uint64_t));
+		out.write((char *)and_count.data(), and_count.size()*sizeof(uint64_t));
+		if(!out)
+			error("cannot write compiled circuit\n");
+	}
+
+	/* Rewrites the wires of gates into slots. The ANDs of a level run in
+	 * parallel, so they all get their output slot before any slot read only
+	 * by them is released; XOR/NOT gates read before they write and may take
+	 * the slot of their own input. */
+	static void assign_slots(BristolFormat * cf, Header * h, std::vector<uint32_t> & gates,
+			const std::vector<uint64_t> & first, const std::vector<uint64_t> & and_count, const std::vector<uint32_t> & last) {
+		const uint32_t OUTPUT = 0x80000000u;
+		int64_t W = h->num_wire, inputs = cf->n1 + cf->n2, outputs = W - cf->n3;
+		std::vector<bool> read(W, false);
+		for(size_t i = 0; i < gates.size(); i += 4)
+			read[gates[i]] = read[gates[i+1]] = true;
+
+		SlotAllocator slots(inputs);
+		std::vector<uint32_t> slot(W);
+		auto release = [&](uint32_t w) {
+			if(w < outputs)
+				slots.put(slot[w]);
+		};
+		auto define = [&](uint32_t w) {
+			slot[w] = w < outputs ? slots.get() : OUTPUT | (uint32_t)(w - outputs);
+		};
+		auto release_inputs = [&](uint64_t i) {
+			const uint32_t * g = gates.data() + 4*i;
+			if(last[g[0]] == i)
+				release(g[0]);
+			if(g[1] != g[0] and last[g[1]] == i)
+				release(g[1]);
+		};
+		for(int64_t w = 0; w < inputs; ++w) {
+			slot[w] = w;
+			if(!read[w])
+				release(w);
+		}
+		for(int64_t l = 0; l < h->num_level; ++l) {
+			uint64_t mid = first[l] + and_count[l];
+			for(uint64_t i = first[l]; i < mid; ++i)
+				define(gates[4*i+2]);
+			for(uint64_t i = first[l]; i < mid; ++i) {
+				release_inputs(i);
+				if(!read[gates[4*i+2]])
+					release(gates[4*i+2]);
+			}
+			for(uint64_t i = mid; i < first[l+1]; ++i) {
+				release_inputs(i);
+				define(gates[4*i+2]);
+				if(!read[gates[4*i+2]])
+					release(gates[4*i+2]);
+			}
+		}
+
+		h->num_slot = slots.num_slot + cf->n3;
+		for(size_t i = 0; i < gates.size(); i += 4)
+			for(int j = 0; j < 3; ++j) {
+				uint32_t s = slot[gates[i+j]];
+				gates[i+j] = s & OUTPUT ? slots.num_slot + (s & ~OUTPUT) : s;
+			}
+	}
+};
+
+/* Garbles or evaluates a CompiledCircuit level by level. The AND gates of a
+ * level are independent, so they are split into contiguous ranges over the
+ * threads of a pool; each thread writes the tables of its range into its own
+ * slab of the level's table buffer, which then goes out as one message in gate
+ * order, so the peer sees the same bytes whatever the thread count. Levels
+ * with fewer than min_chunk ANDs per thread stay on the calling thread.
+ * Uses the delta and public labels of the current HalfGateGen/HalfGateEva and
+ * gate ids from the current SemiHonestParty; both parties must call compute()
+ * in the same order. */
+template<typename IO>
+class LevelParallelCircuit { public:
+	const CompiledCircuit * cc;
+	IO * io;
+	SemiHonestParty<IO> * ctx;
+	int party, threads;
+	int64_t min_chunk = 256;
+	block delta, one;
+	uint64_t gid = 0;	// of the next level's first AND gate
+	uint64_t num_and = 0;
+	ThreadPool * pool = nullptr;
+
+	std::vector<block> wire, table;
+	std::vector<std::vector<block>> scratch;	// per thread
+	static const int64_t CHUNK = 1024;	// ANDs hashed at once per thread
+
+	LevelParallelCircuit(const CompiledCircuit * cc, IO * io, int threads) : cc(cc), io(io), threads(threads) {
+		ctx = dynamic_cast<SemiHonestParty<IO>*>(ProtocolExecution::prot_exec);
+		if(ctx == nullptr)
+			error("LevelParallelCircuit needs a SemiHonestParty\n");
+		party = ctx->cur_party;
+		if(party == ALICE)
+			delta = ((HalfGateGen<IO>*)CircuitExecution::circ_exec)->delta;
+		one = CircuitExecution::circ_exec->public_label(true);
+		if(threads > 1)
+			pool = new ThreadPool(threads);
+		uint64_t widest = 0;
+		for(int64_t l = 0; l < cc->header->num_level; ++l)
+			widest = std::max(widest, cc->level_and[l]);
+		wire.resize(cc->header->num_slot);
+		table.resize(2*widest);
+		scratch.resize(threads, std::vector<block>(15*CHUNK));
+	}
+
+	~LevelParallelCircuit() {
+		delete pool;
+	}
+
+	void compute(block * out, const block * in1, const block * in2) {
+		flush_inputs();
+		const CompiledCircuit::Header * h = cc->header;
+		gid = ctx->reserve_gate_ids(h->num_and);
+		block * w = wire.data();
+		memcpy(w, in1, h->n1*sizeof(block));
+		memcpy(w + h->n1, in2, h->n2*sizeof(block));
+		for(int64_t l = 0; l < h->num_level; ++l) {
+			int64_t first = cc->level[l], nand = cc->level_and[l];
+			if(nand > 0) {
+				if(party == BOB)
+					io->recv_block(table.data(), 2*nand);
+				int64_t parts = std::max<int64_t>(1, std::min<int64_t>(threads, nand/min_chunk));
+				if(parts == 1)
+					and_range(first, 0, nand, 0);
+				else {
+					std::vector<std::future<void>> res;
+					for(int64_t t = 0; t < parts; ++t)
+						res.push_back(pool->enqueue([this, first, nand, parts, t]() {
+							and_range(first, nand*t/parts, nand*(t+1)/parts, t);
+						}));
+					for(auto & r : res)
+						r.get();
+				}
+				if(party == ALICE)
+					io->send_block(table.data(), 2*nand);
+				gid += nand;
+				num_and += nand;
+				ctx->counted.num_and += nand;
+			}
+			for(uint64_t i = first + nand; i < cc->level[l+1]; ++i) {
+				const uint32_t * g = cc->gates + 4*i;
+				w[g[2]] = g[3] == XOR_GATE ? w[g[0]] ^ w[g[1]] : w[g[0]] ^ one;
+				ctx->counted.num_xor += g[3] == XOR_GATE;
+			}
+		}
+		memcpy(out, w + h->num_slot - h->n3, h->n3*sizeof(block));
+	}
+
+	// ANDs [lo, hi) of the level starting at gate first, on thread t
+	void and_range(int64_t first, int64_t lo, int64_t hi, int t) {
+		block * a = scratch[t].data(), * b = a + CHUNK, * c = b + CHUNK, * s = c + CHUNK;
+		for(int64_t i = lo; i < hi; i += CHUNK) {
+			int n = hi - i < CHUNK ? hi - i : CHUNK;
+			const uint32_t * g = cc->gates + 4*(first + i);
+			for(int k = 0; k < n; ++k) {
+				a[k] = wire[g[4*k]];
+				b[k] = wire[g[4*k+1]];
+			}
+			if(party == ALICE)
+				halfgate_garble(c, table.data() + 2*i, a, b, n, delta, gid + i, s, &ctx->gate_key);
+			else halfgate_eval(c, table.data() + 2*i, a, b, n, gid + i, s, &ctx->gate_key);
+			for(int k = 0; k < n; ++k)
+				wire[g[4*k+2]] = c[k];
+		}
+	}
+};
+
+}
+#endif
@@ -0,0 +1,126 @@
+#ifndef EMP_CIRCUIT_OPTIMIZE_H__
+#define EMP_CIRCUIT_OPTIMIZE_H__
+#include "emp-sh2pc/circuit_trace.h"
+#include <unordered_map>
+
+namespace emp {
+
+// A gate by its type and canonical inputs, for common subexpressions
+struct GateKey {
+	uint32_t type, a, b;
+
+	bool operator==(const GateKey & k) const {
+		return type == k.type and a == k.a and b == k.b;
+	}
+};
+
+struct GateKeyHash {
+	size_t operator()(const GateKey & k) const {
+		return std::hash<uint64_t>()(((uint64_t)k.a << 32) | k.b) * 3 + k.type;
+	}
+};
+
+/* Simplifies a traced circuit before it is garbled:
+ * - constant propagation from the PUBLIC wires 0 and 1,
+ * - x^x = 0, x^!x = 1, x&x = x, x&!x = 0, !!x = x,
+ * - common subexpressions, with the inputs of AND/XOR in canonical order,
+ * - removal of gates no output depends on.
+ * Inputs keep their wires and the outputs their order, so the result replays
+ * with the same labels as ir. */
+inline TracedCircuit optimize_circuit(const TracedCircuit & ir) {
+	uint32_t first = 2 + ir.num_input;
+	std::vector<uint32_t> map(ir.num_wire);
+	for(uint32_t w = 0; w < first; ++w)
+		map[w] = w;
+
+	std::vector<TracedGate> gates;
+	std::unordered_map<GateKey, uint32_t, GateKeyHash> cse;
+	std::unordered_map<uint32_t, uint32_t> not_of;
+	uint32_t num_wire = first;
+	auto make = [&](uint32_t type, uint32_t a, uint32_t b) -> uint32_t {
+		if(a > b)
+			std::swap(a, b);
+		GateKey key = {type, a, b};
+		auto it = cse.find(key);
+		if(it != cse.end())
+			return it->second;
+		TracedGate g = {a, b, num_wire, type};
+		gates.push_back(g);
+		if(type == TRACE_NOT) {
+			not_of[num_wire] = a;
+			not_of[a] = num_wire;
+		}
+		cse[key] = num_wire;
+		return num_wire++;
+	};
+	auto negated = [&](uint32_t a, uint32_t b) {
+		auto it = not_of.find(a);
+		return it != not_of.end() and it->second == b;
+	};
+	auto negate = [&](uint32_t a) -> uint32_t {
+		if(a < 2)
+			return 1 - a;
+		auto it = not_of.find(a);
+		if(it != not_of.end())
+			return it->second;
+		return make(TRACE_NOT, a, a);
+	};
+
+	for(const auto & g : ir.gates) {
+		uint32_t a = map[g.in0], b = map[g.in1], res;
+		if(g.type == TRACE_NOT)
+			res = negate(a);
+		else if(g.type == TRACE_XOR) {
+			if(a == b)
+				res = 0;
+			else if(negated(a, b))
+				res = 1;
+			else if(a < 2 or b < 2) {
+				uint32_t c = a < 2 ? a : b, x = a < 2 ? b : a;
+				res = c == 0 ? x : negate(x);
+			} else res = make(TRACE_XOR, a, b);
+		} else {
+			if(a == 0 or b == 0 or negated(a, b))
+				res = 0;
+			else if(a == 1 or a == b)
+				res = b;
+			else if(b == 1)
+				res = a;
+			else res = make(TRACE_AND, a, b);
+		}
+		map[g.out] = res;
+	}
+
+	// keep the gates some output depends on, renumbered densely
+	std::vector<bool> live(num_wire, false);
+	for(uint32_t w : ir.outputs)
+		live[map[w]] = true;
+	for(size_t i = gates.size(); i-- > 0;)
+		if(live[gates[i].out]) {
+			live[gates[i].in0] = true;
+			live[gates[i].in1] = true;
+		}
+
+	TracedCircuit res;
+	res.num_input = ir.num_input;
+	res.num_wire = first;
+	std::vector<uint32_t> renum(num_wire);
+	for(uint32_t w = 0; w < first; ++w)
+		renum[w] = w;
+	for(auto g : gates) {
+		if(!live[g.out])
+			continue;
+		g.in0 = renum[g.in0];
+		g.in1 = renum[g.in1];
+		g.out = renum[g.out] = res.num_wire++;
+		res.gates.push_back(g);
+		if(g.type == TRACE_AND)
+			++res.num_and;
+	}
+	for(uint32_t w : ir.outputs)
+		res.outputs.push_back(renum[map[w]]);
+	return res;
+}
+
+}
+#endif
@@ -0,0 +1,219 @@
+#ifndef EMP_CIRCUIT_TRACE_H__
+#define EMP_CIRCUIT_TRACE_H__
+#include "emp-tool/emp-tool.h"
+#include "emp-sh2pc/sh_session.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace emp {
+
+enum TracedGateType {
+	TRACE_AND = 0,
+	TRACE_XOR = 1,
+	TRACE_NOT = 2,	// in1 unused
+};
+
+struct TracedGate {
+	uint32_t in0, in1, out, type;
+};
+
+/* Flat gate list of a circuit of fixed shape. Wires 0 and 1 are the public
+ * constants false and true, wires 2 .. num_input+1 the inputs; gates are in
+ * evaluation order and every gate names its output wire. */
+class TracedCircuit { public:
+	static const uint64_t MAGIC = 0x65636172746370ULL;
+	uint32_t num_wire = 2;
+	uint32_t num_input = 0;
+	uint64_t num_and = 0;
+	std::vector<TracedGate> gates;
+	std::vector<uint32_t> outputs;
+
+	TracedCircuit() {}
+
+	TracedCircuit(const std::string & file) {
+		if(!load(file))
+			error("cannot read traced circuit\n");
+	}
+
+	// The label standing for wire w while tracing
+	static block label(uint32_t w) {
+		return makeBlock(0, w);
+	}
+
+	static uint32_t wire(const block & label) {
+		uint64_t w[2];
+		memcpy(w, &label, sizeof(block));
+		return (uint32_t)w[0];
+	}
+
+	void save(const std::string & file) const {
+		std::ofstream out(file, std::ios::binary | std::ios::trunc);
+		uint64_t head[6] = {MAGIC, num_wire, num_input, num_and, gates.size(), outputs.size()};
+		out.write((char *)head, sizeof(head));
+		out.write((char *)gates.data(), gates.size()*sizeof(TracedGate));
+		out.write((char *)outputs.data(), outputs.size()*sizeof(uint32_t));
+		if(!out)
+			error("cannot write traced circuit\n");
+	}
+
+	/* false if file cannot be read or is no traced circuit; error() if it is
+	 * one but truncated or inconsistent, since replaying it would index
+	 * labels out of bounds. */
+	bool load(const std::string & file) {
+		std::ifstream in(file, std::ios::binary | std::ios::ate);
+		if(!in)
+			return false;
+		uint64_t size = in.tellg();
+		in.seekg(0);
+		uint64_t head[6];
+		if(!in.read((char *)head, sizeof(head)) or head[0] != MAGIC)
+			return false;
+		if(head[1] > UINT32_MAX or head[2] + 2 > head[1]
+				or head[4] > (size - sizeof(head))/sizeof(TracedGate)
+				or head[5] > (size - sizeof(head))/sizeof(uint32_t)
+				or size != sizeof(head) + head[4]*sizeof(TracedGate) + head[5]*sizeof(uint32_t))
+			error("traced circuit: header does not match the file\n");
+		num_wire = head[1];
+		num_input = head[2];
+		num_and = head[3];
+		gates.resize(head[4]);
+		outputs.resize(head[5]);
+		if(!in.read((char *)gates.data(), gates.size()*sizeof(TracedGate))
+				or !in.read((char *)outputs.data(), outputs.size()*sizeof(uint32_t)))
+			error("traced circuit: truncated\n");
+		uint64_t ands = 0;
+		for(const TracedGate & g : gates) {
+			if(g.type > TRACE_NOT or g.in0 >= num_wire or (g.type != TRACE_NOT and g.in1 >= num_wire)
+					or g.out < 2 or g.out >= num_wire)
+				error("traced circuit: gate wire out of range\n");
+			ands += g.type == TRACE_AND;
+		}
+		if(ands != num_and)
+			error("traced circuit: AND count does not match the gates\n");
+		for(uint32_t w : outputs)
+			if(w >= num_wire)
+				error("traced circuit: output wire out of range\n");
+		return true;
+	}
+};
+
+/* Records gates instead of executing them: every label is the index of a
+ * wire, and every gate appends to the circuit and returns a fresh wire. */
+class CircuitTracer: public CircuitExecution { public:
+	TracedCircuit * ir;
+
+	CircuitTracer(TracedCircuit * ir) : ir(ir) {}
+
+	block emit(uint32_t type, const block & a, const block & b) {
+		TracedGate g = {TracedCircuit::wire(a), TracedCircuit::wire(b), ir->num_wire++, type};
+		ir->gates.push_back(g);
+		return TracedCircuit::label(g.out);
+	}
+
+	block and_gate(const block & a, const block & b) override {
+		++ir->num_and;
+		return emit(TRACE_AND, a, b);
+	}
+
+	block xor_gate(const block & a, const block & b) override {
+		return emit(TRACE_XOR, a, b);
+	}
+
+	block not_gate(const block & a) override {
+		return emit(TRACE_NOT, a, a);
+	}
+
+	block public_label(bool b) override {
+		return TracedCircuit::label(b);
+	}
+
+	uint64_t num_and() override {
+		return ir->num_and;
+	}
+};
+
+/* Traces f, which maps num_input Bits to its output Bits using gates and
+ * PUBLIC constants only (no feed() or reveal()). Both parties trace the same
+ * function and get the same circuit. */
+template<typename F>
+inline TracedCircuit trace_circuit(uint32_t num_input, F f) {
+	TracedCircuit ir;
+	ir.num_input = num_input;
+	ir.num_wire = 2 + num_input;
+	CircuitTracer tracer(&ir);
+	ExecutionScope scope(&tracer, nullptr);
+	std::vector<Bit> in;
+	for(uint32_t i = 0; i < num_input; ++i)
+		in.push_back(Bit(TracedCircuit::label(2 + i)));
+	std::vector<Bit> out = f(in);
+	for(const auto & b : out)
+		ir.outputs.push_back(TracedCircuit::wire(b.bit));
+	return ir;
+}
+
+// Gates called on the concrete type, so they can be inlined
+template<typename Circ>
+struct DirectGates {
+	Circ * c;
+	block and_gate(const block & a, const block & b) { return c->Circ::and_gate(a, b); }
+	block xor_gate(const block & a, const block & b) { return a ^ b; }
+	block not_gate(const block & a) { return c->Circ::not_gate(a); }
+};
+
+struct VirtualGates {
+	CircuitExecution * c;
+	block and_gate(const block & a, const block & b) { return c->and_gate(a, b); }
+	block xor_gate(const block & a, const block & b) { return c->xor_gate(a, b); }
+	block not_gate(const block & a) { return c->not_gate(a); }
+};
+
+/* Garbles or evaluates a traced circuit on the current circ_exec, once per
+ * call to compute(). Labels live in one array allocated up front, and with a
+ * HalfGateGen/HalfGateEva over IO the gates are called without virtual
+ * dispatch. */
+template<typename IO>
+class CircuitReplay { public:
+	const TracedCircuit * ir;
+	std::vector<block> wire;
+
+	CircuitReplay(const TracedCircuit * ir) : ir(ir), wire(ir->num_wire) {}
+
+	// in: num_input labels, out: one label per output
+	void compute(block * out, const block * in) {
+		flush_inputs();
+		CircuitExecution * c = CircuitExecution::circ_exec;
+		if(HalfGateGen<IO> * gen = dynamic_cast<HalfGateGen<IO>*>(c))
+			run(DirectGates<HalfGateGen<IO>>{gen}, out, in);
+		else if(HalfGateEva<IO> * eva = dynamic_cast<HalfGateEva<IO>*>(c))
+			run(DirectGates<HalfGateEva<IO>>{eva}, out, in);
+		else run(VirtualGates{c}, out, in);
+	}
+
+	template<typename Gates>
+	void run(Gates g, block * out, const block * in) {
+		block * w = wire.data();
+		w[0] = CircuitExecution::circ_exec->public_label(false);
+		w[1] = CircuitExecution::circ_exec->public_label(true);
+		memcpy(w + 2, in, ir->num_input*sizeof(block));
+		const TracedGate * gate = ir->gates.data();
+		for(size_t i = 0; i < ir->gates.size(); ++i) {
+			const TracedGate & t = gate[i];
+			switch(t.type) {
+			case TRACE_AND:
+				w[t.out] = g.and_gate(w[t.in0], w[t.in1]);
+				break;
+			case TRACE_XOR:
+				w[t.out] = g.xor_gate(w[t.in0], w[t.in1]);
+				break;
+			default:
+				w[t.out] = g.not_gate(w[t.in0]);
+			}
+		}
+		for(size_t i = 0; i < ir->outputs.size(); ++i)
+			out[i] = w[ir->outputs[i]];
+	}
+};
+
+}
+#endif
@@ -1,4 +1,19 @@
 #include "emp-sh2pc/semihonest.h"
 #include "emp-sh2pc/sh_party.h"
 #include "emp-sh2pc/sh_gen.h"
-#include "emp-sh2pc/sh_eva.h"
\ No newline at end of file
+#include "emp-sh2pc/sh_eva.h"
+#include "emp-sh2pc/sh_batch.h"
+#include "emp-sh2pc/sh_cot_pool.h"
+#include "emp-sh2pc/sh_session.h"
+#include "emp-sh2pc/sh_base_ot_cache.h"
+#include "emp-sh2pc/sh_parallel.h"
+#include "emp-sh2pc/string_match.h"
+#include "emp-sh2pc/regex_match.h"
+#include "emp-sh2pc/circuit_trace.h"
+#include "emp-sh2pc/circuit_optimize.h"
+#include "emp-sh2pc/bristol_batch.h"
+#include "emp-sh2pc/bristol_compiled.h"
+#include "emp-sh2pc/wire_slots.h"
+#include "emp-sh2pc/label_arena.h"
+#include "emp-sh2pc/sh_stats.h"
+#include "emp-sh2pc/sh_profile.h"
@@ -0,0 +1,210 @@
+#ifndef EMP_LABEL_ARENA_H__
+#define EMP_LABEL_ARENA_H__
+#include "emp-tool/emp-tool.h"
+#include <cstdlib>
+#include <vector>
+
+namespace emp {
+
+/* Bump allocator for labels. Every allocation starts on a 64-byte boundary
+ * and is contiguous; memory is given back in bulk by release() to an earlier
+ * mark() or by reset(). Chunks are kept for reuse, so a loop that allocates
+ * and releases the same amount each round stops calling malloc after the
+ * first one. */
+class LabelArena { public:
+	static const size_t ALIGN = 64;
+	struct Chunk {
+		block * data;
+		size_t size;	// in blocks
+	};
+	struct Mark {
+		size_t chunk, used;
+	};
+
+	std::vector<Chunk> chunks;
+	size_t chunk = 0;	// chunk allocations are served from
+	size_t used = 0;	// blocks used in it
+	size_t chunk_size;
+
+	LabelArena(size_t chunk_size = 1<<16) : chunk_size(chunk_size) {}
+
+	~LabelArena() {
+		for(auto & c : chunks)
+			free(c.data);
+	}
+
+	LabelArena(const LabelArena &) = delete;
+	LabelArena & operator=(const LabelArena &) = delete;
+
+	block * alloc(size_t n) {
+		const size_t per_line = ALIGN/sizeof(block);
+		n = (n + per_line - 1)/per_line*per_line;
+		if(chunks.empty() or used + n > chunks[chunk].size) {
+			size_t next = chunks.empty() ? 0 : chunk + 1;
+			if(next == chunks.size() or chunks[next].size < n) {
+				Chunk c;
+				c.size = std::max(chunk_size, n);
+				void * ptr = nullptr;
+				if(posix_memalign(&ptr, ALIGN, c.size*sizeof(block)) != 0)
+					error("label arena out of memory\n");
+				c.data = (block *)ptr;
+				chunks.insert(chunks.begin() + next, c);
+			}
+			chunk = next;
+			used = 0;
+		}
+		block * res = chunks[chunk].data + used;
+		used += n;
+		return res;
+	}
+
+	Mark mark() const {
+		return Mark{chunk, used};
+	}
+
+	// Frees everything allocated after m
+	void release(const Mark & m) {
+		chunk = m.chunk;
+		used = m.used;
+	}
+
+	void reset() {
+		release(Mark{0, 0});
+	}
+
+	size_t capacity() const {
+		size_t res = 0;
+		for(const auto & c : chunks)
+			res += c.size*sizeof(block);
+		return res;
+	}
+
+	// Arena of the current thread, installed by ArenaScope
+	static LabelArena *& current() {
+		static thread_local LabelArena * arena = nullptr;
+		return arena;
+	}
+};
+
+/* Makes arena current on this thread for the lifetime of the scope and frees
+ * everything allocated from it inside the scope on exit. */
+class ArenaScope { public:
+	LabelArena * arena;
+	LabelArena * prev;
+	LabelArena::Mark mark;
+
+	ArenaScope(LabelArena & arena) : arena(&arena), prev(LabelArena::current()), mark(arena.mark()) {
+		LabelArena::current() = &arena;
+	}
+
+	~ArenaScope() {
+		arena->release(mark);
+		LabelArena::current() = prev;
+	}
+
+	ArenaScope(const ArenaScope &) = delete;
+	ArenaScope & operator=(const ArenaScope &) = delete;
+};
+
+/* A fixed-width secret value whose labels live in the current arena, for hot
+ * loops where the heap allocation behind every Integer and every temporary
+ * shows up next to the AES. Copies share labels; the value is valid until the
+ * ArenaScope it was created in ends. Bit i is the i-th LSB, as in Integer. */
+class ArenaBits { public:
+	Bit * bits = nullptr;
+	int length = 0;
+
+	ArenaBits() {}
+
+	explicit ArenaBits(int length) : length(length) {
+		bits = (Bit *)arena()->alloc(length);
+	}
+
+	ArenaBits(int length, int64_t input, int party = PUBLIC) : ArenaBits(length) {
+		LabelArena::Mark m = arena()->mark();
+		bool * b = (bool *)arena()->alloc(length/sizeof(block) + 1);
+		for(int i = 0; i < length; ++i)
+			b[i] = i < 64 ? (input >> i) & 1 : input < 0;
+		if(party == PUBLIC) {
+			block zero = CircuitExecution::circ_exec->public_label(false);
+			block one = CircuitExecution::circ_exec->public_label(true);
+			for(int i = 0; i < length; ++i)
+				bits[i] = Bit(b[i] ? one : zero);
+		} else ProtocolExecution::prot_exec->feed((block *)bits, party, b, length);
+		arena()->release(m);
+	}
+
+	explicit ArenaBits(const Integer & x) : ArenaBits(x.size()) {
+		memcpy(bits, x.bits.data(), length*sizeof(block));
+	}
+
+	static LabelArena * arena() {
+		LabelArena * a = LabelArena::current();
+		if(a == nullptr)
+			error("ArenaBits needs an ArenaScope\n");
+		return a;
+	}
+
+	int size() const {
+		return length;
+	}
+
+	Bit & operator[](int i) {
+		return bits[i];
+	}
+
+	const Bit & operator[](int i) const {
+		return bits[i];
+	}
+
+	Integer integer() const {
+		Integer res;
+		res.bits.assign(bits, bits + length);
+		return res;
+	}
+
+	template<typename Op>
+	ArenaBits bitwise(const ArenaBits & rhs, Op op) const {
+		ArenaBits res(length);
+		for(int i = 0; i < length; ++i)
+			res.bits[i] = op(bits[i], rhs.bits[i]);
+		return res;
+	}
+
+	ArenaBits operator^(const ArenaBits & rhs) const {
+		return bitwise(rhs, [](const Bit & a, const Bit & b) { return a ^ b; });
+	}
+
+	ArenaBits operator&(const ArenaBits & rhs) const {
+		return bitwise(rhs, [](const Bit & a, const Bit & b) { return a & b; });
+	}
+
+	ArenaBits operator|(const ArenaBits & rhs) const {
+		return bitwise(rhs, [](const Bit & a, const Bit & b) { return a | b; });
+	}
+
+	/* length-1 ANDs in a balanced tree, as Integer's ==; the scratch labels
+	 * are released before returning. */
+	Bit operator==(const ArenaBits & rhs) const {
+		LabelArena::Mark m = arena()->mark();
+		ArenaBits eq(length);
+		for(int i = 0; i < length; ++i)
+			eq.bits[i] = !(bits[i] ^ rhs.bits[i]);
+		for(int n = length; n > 1; n = (n + 1)/2) {
+			for(int i = 0; i < n/2; ++i)
+				eq.bits[i] = eq.bits[2*i] & eq.bits[2*i+1];
+			if(n % 2 == 1)
+				eq.bits[n/2] = eq.bits[n-1];
+		}
+		Bit res = length == 0 ? Bit(true, PUBLIC) : eq.bits[0];
+		arena()->release(m);
+		return res;
+	}
+
+	Bit operator!=(const ArenaBits & rhs) const {
+		return !(*this == rhs);
+	}
+};
+
+}
+#endif
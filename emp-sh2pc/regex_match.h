@@ -0,0 +1,411 @@
+#ifndef EMP_REGEX_MATCH_H__
+#define EMP_REGEX_MATCH_H__
+#include "emp-tool/emp-tool.h"
+#include "emp-sh2pc/string_match.h"
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace emp {
+
+/* Symbols of a public alphabet: a character is its index in alphabet and
+ * every other character shares the last symbol, as in SecretString. An empty
+ * alphabet means all 256 bytes. */
+inline int regex_num_symbols(const std::string & alphabet) {
+	return alphabet.empty() ? 256 : alphabet.size() + 1;
+}
+
+inline int regex_symbol(char c, const std::string & alphabet) {
+	if(alphabet.empty())
+		return (uint8_t)c;
+	size_t pos = alphabet.find(c);
+	return pos == std::string::npos ? alphabet.size() : pos;
+}
+
+/* Plain DFA that searches for a regular expression anywhere in a text: after
+ * reading text[0..i] it is in an accepting state iff some non-empty match ends
+ * at character i. State 0 is the initial one. */
+struct Dfa {
+	int num_symbols = 0;
+	std::vector<int> next;		// next[q*num_symbols + a]
+	std::vector<bool> accept;
+
+	int size() const {
+		return accept.size();
+	}
+
+	/* Supports literals, '.', classes with ranges and '^', '|', '*', '+', '?',
+	 * grouping and '\' escapes. The result is minimized. */
+	static Dfa compile(const std::string & regex, const std::string & alphabet = "", int max_states = 1<<16);
+};
+
+/* Thompson construction: every fragment has one entry and one exit state. */
+class RegexParser { public:
+	typedef std::pair<int, int> Frag;
+	const std::string & re;
+	const std::string & alphabet;
+	int num_symbols;
+	size_t pos = 0;
+	std::vector<std::vector<int>> eps;
+	std::vector<std::vector<std::pair<std::vector<bool>, int>>> edges;
+
+	RegexParser(const std::string & re, const std::string & alphabet)
+		: re(re), alphabet(alphabet), num_symbols(regex_num_symbols(alphabet)) {}
+
+	int state() {
+		eps.emplace_back();
+		edges.emplace_back();
+		return eps.size() - 1;
+	}
+
+	Frag parse() {
+		Frag f = alternation();
+		if(pos != re.size())
+			error("regex: unbalanced ')'\n");
+		return f;
+	}
+
+	Frag alternation() {
+		Frag f = concat();
+		while(pos < re.size() and re[pos] == '|') {
+			++pos;
+			Frag g = concat();
+			int s = state(), e = state();
+			eps[s].push_back(f.first);
+			eps[s].push_back(g.first);
+			eps[f.second].push_back(e);
+			eps[g.second].push_back(e);
+			f = Frag(s, e);
+		}
+		return f;
+	}
+
+	Frag concat() {
+		int s = state();
+		Frag f(s, s);
+		while(pos < re.size() and re[pos] != '|' and re[pos] != ')') {
+			Frag g = repeat();
+			eps[f.second].push_back(g.first);
+			f.second = g.second;
+		}
+		return f;
+	}
+
+	Frag repeat() {
+		Frag f = atom();
+		while(pos < re.size() and (re[pos] == '*' or re[pos] == '+' or re[pos] == '?')) {
+			char op = re[pos++];
+			int s = state(), e = state();
+			eps[s].push_back(f.first);
+			eps[f.second].push_back(e);
+			if(op != '+')
+				eps[s].push_back(e);
+			if(op != '?')
+				eps[f.second].push_back(f.first);
+			f = Frag(s, e);
+		}
+		return f;
+	}
+
+	Frag atom() {
+		char c = re[pos++];
+		if(c == '(') {
+			Frag f = alternation();
+			if(pos == re.size() or re[pos] != ')')
+				error("regex: missing ')'\n");
+			++pos;
+			return f;
+		}
+		if(c == '*' or c == '+' or c == '?')
+			error("regex: nothing to repeat\n");
+		std::vector<bool> set(num_symbols, c == '.');
+		if(c == '[')
+			set = char_class();
+		else if(c != '.')
+			set[symbol(escaped(c))] = true;
+		int s = state(), e = state();
+		edges[s].emplace_back(set, e);
+		return Frag(s, e);
+	}
+
+	std::vector<bool> char_class() {
+		std::vector<bool> set(num_symbols, false);
+		bool negate = pos < re.size() and re[pos] == '^';
+		if(negate)
+			++pos;
+		while(pos < re.size() and re[pos] != ']') {
+			char lo = escaped(re[pos++]);
+			if(pos + 1 < re.size() and re[pos] == '-' and re[pos+1] != ']') {
+				++pos;
+				char hi = escaped(re[pos++]);
+				// characters of the range outside the alphabet are skipped
+				for(int ch = (uint8_t)lo; ch <= (uint8_t)hi; ++ch)
+					if(alphabet.empty() or alphabet.find((char)ch) != std::string::npos)
+						set[regex_symbol((char)ch, alphabet)] = true;
+			} else set[symbol(lo)] = true;
+		}
+		if(pos == re.size())
+			error("regex: missing ']'\n");
+		++pos;
+		if(negate)
+			set.flip();
+		return set;
+	}
+
+	char escaped(char c) {
+		if(c != '\\')
+			return c;
+		if(pos == re.size())
+			error("regex: trailing '\\'\n");
+		return re[pos++];
+	}
+
+	int symbol(char c) {
+		if(!alphabet.empty() and alphabet.find(c) == std::string::npos)
+			error("regex: character outside the alphabet\n");
+		return regex_symbol(c, alphabet);
+	}
+
+	void closure(std::vector<bool> & set) {
+		std::vector<int> todo;
+		for(size_t i = 0; i < set.size(); ++i)
+			if(set[i])
+				todo.push_back(i);
+		while(!todo.empty()) {
+			int s = todo.back();
+			todo.pop_back();
+			for(int t : eps[s])
+				if(!set[t]) {
+					set[t] = true;
+					todo.push_back(t);
+				}
+		}
+	}
+};
+
+inline Dfa Dfa::compile(const std::string & regex, const std::string & alphabet, int max_states) {
+	RegexParser parser(regex, alphabet);
+	RegexParser::Frag frag = parser.parse();
+	int n = parser.eps.size(), symbols = parser.num_symbols;
+	std::vector<bool> start(n, false);
+	start[frag.first] = true;
+	parser.closure(start);
+
+	// Subset construction. A state is the closed set of NFA states reached by
+	// matches still in progress; the start set is joined in before every
+	// character, so matches may begin anywhere.
+	std::map<std::vector<bool>, int> ids;
+	std::vector<std::vector<bool>> sets(1, std::vector<bool>(n, false));
+	ids[sets[0]] = 0;
+	std::vector<int> next;
+	for(size_t q = 0; q < sets.size(); ++q) {
+		std::vector<bool> from = sets[q];
+		for(int s = 0; s < n; ++s)
+			if(start[s])
+				from[s] = true;
+		for(int a = 0; a < symbols; ++a) {
+			std::vector<bool> to(n, false);
+			for(int s = 0; s < n; ++s)
+				if(from[s])
+					for(const auto & e : parser.edges[s])
+						if(e.first[a])
+							to[e.second] = true;
+			parser.closure(to);
+			auto it = ids.find(to);
+			if(it == ids.end()) {
+				if((int)sets.size() == max_states)
+					error("regex: too many DFA states\n");
+				it = ids.emplace(to, sets.size()).first;
+				sets.push_back(to);
+			}
+			next.push_back(it->second);
+		}
+	}
+
+	// Moore minimization; classes are numbered in order of their first state,
+	// so state 0 stays initial.
+	int m = sets.size(), num_class = 0;
+	std::vector<int> cls(m);
+	for(int q = 0; q < m; ++q)
+		cls[q] = sets[q][frag.second];
+	while(true) {
+		std::map<std::vector<int>, int> keys;
+		std::vector<int> refined(m);
+		for(int q = 0; q < m; ++q) {
+			std::vector<int> key(1, cls[q]);
+			for(int a = 0; a < symbols; ++a)
+				key.push_back(cls[next[q*symbols + a]]);
+			refined[q] = keys.emplace(key, keys.size()).first->second;
+		}
+		cls = refined;
+		if((int)keys.size() == num_class)
+			break;
+		num_class = keys.size();
+	}
+
+	Dfa dfa;
+	dfa.num_symbols = symbols;
+	dfa.next.resize(num_class * symbols);
+	dfa.accept.resize(num_class);
+	for(int q = 0; q < m; ++q) {
+		dfa.accept[cls[q]] = sets[q][frag.second];
+		for(int a = 0; a < symbols; ++a)
+			dfa.next[cls[q]*symbols + a] = cls[next[q*symbols + a]];
+	}
+	return dfa;
+}
+
+// Bits needed for a state index
+inline int state_width(int num_states) {
+	int w = 1;
+	while((1 << w) < num_states)
+		++w;
+	return w;
+}
+
+/* A secret DFA padded to a public number of states. For every state and
+ * symbol the next state is stored as a width-bit index, LSB first, and every
+ * state has an accept bit; all of it is fed with a single call to feed(). */
+class SecretDfa { public:
+	int num_states = 0;
+	int num_symbols = 0;
+	int width = 0;
+	std::string alphabet;
+	std::vector<Bit> next;		// next[(q*num_symbols + a)*width + j]
+	std::vector<Bit> accept;
+
+	/* Only the party holding regex compiles it; the other one passes the
+	 * agreed num_states and an empty regex. */
+	SecretDfa(int num_states, const std::string & regex, int party, const std::string & alphabet = "") {
+		this->num_states = num_states;
+		this->alphabet = alphabet;
+		num_symbols = regex_num_symbols(alphabet);
+		width = state_width(num_states);
+		int table = num_states*num_symbols*width;
+		bool * b = new bool[table + num_states];
+		memset(b, false, table + num_states);
+		if(party == PUBLIC or party == ProtocolExecution::prot_exec->cur_party) {
+			Dfa dfa = Dfa::compile(regex, alphabet);
+			if(dfa.size() > num_states)
+				error("regex needs more states than agreed\n");
+			// padding states stay rejecting and go to state 0
+			for(int q = 0; q < dfa.size(); ++q) {
+				for(int a = 0; a < num_symbols; ++a)
+					for(int j = 0; j < width; ++j)
+						b[(q*num_symbols + a)*width + j] = (dfa.next[q*num_symbols + a] >> j) & 1;
+				b[table + q] = dfa.accept[q];
+			}
+		}
+		std::vector<Bit> all(table + num_states);
+		if(party == PUBLIC) {
+			for(int i = 0; i < table + num_states; ++i)
+				all[i] = Bit(b[i], PUBLIC);
+		} else ProtocolExecution::prot_exec->feed((block *)all.data(), party, b, table + num_states);
+		next.assign(all.begin(), all.begin() + table);
+		accept.assign(all.begin() + table, all.end());
+		move_inputs((block *)all.data(), all.size(), [&](size_t i) {
+			return (block *)(i < (size_t)table ? next.data() + i : accept.data() + i - table);
+		});
+		delete[] b;
+	}
+};
+
+/* A secret string with every character as a one-hot vector over the symbols
+ * of the alphabet, fed with a single call to feed(). The holder knows the
+ * characters, so the encoding costs input bits but no gates. */
+class OneHotString { public:
+	std::vector<Bit> bits;
+	int length = 0;
+	int num_symbols = 0;
+	std::string alphabet;
+
+	OneHotString(int length, const std::string & str, int party, const std::string & alphabet = "") {
+		this->length = length;
+		this->alphabet = alphabet;
+		num_symbols = regex_num_symbols(alphabet);
+		bool * b = new bool[num_symbols*length];
+		memset(b, false, num_symbols*length);
+		for(int i = 0; i < length and i < (int)str.size(); ++i)
+			b[num_symbols*i + regex_symbol(str[i], alphabet)] = true;
+		bits.resize(num_symbols*length);
+		if(party == PUBLIC) {
+			for(int i = 0; i < num_symbols*length; ++i)
+				bits[i] = Bit(b[i], PUBLIC);
+		} else if(length > 0)
+			ProtocolExecution::prot_exec->feed((block *)bits.data(), party, b, num_symbols*length);
+		delete[] b;
+	}
+
+	int size() const {
+		return length;
+	}
+
+	const Bit * operator[](int i) const {
+		return bits.data() + num_symbols*i;
+	}
+};
+
+/* One-hot vector of the value of index (LSB first), truncated to n entries.
+ * Built from the most significant bit down, each bit splits every entry in
+ * two with one AND: about n ANDs in total. */
+inline std::vector<Bit> one_hot(const std::vector<Bit> & index, int n) {
+	int w = index.size();
+	std::vector<Bit> res(1, Bit(true, PUBLIC));
+	for(int j = w - 1; j >= 0; --j) {
+		int keep = ((n - 1) >> j) + 1;
+		std::vector<Bit> split(keep);
+		for(size_t h = 0; h < res.size(); ++h) {
+			Bit hi = j == w - 1 ? index[j] : res[h] & index[j];
+			if((int)(2*h) < keep)
+				split[2*h] = res[h] ^ hi;
+			if((int)(2*h + 1) < keep)
+				split[2*h + 1] = hi;
+		}
+		res = split;
+	}
+	return res;
+}
+
+/* Runs dfa over text, one character per step, with the state as a one-hot
+ * vector. A step first selects, for every state, the index of its successor
+ * on the current character (the character is one-hot, so this is an XOR of
+ * ANDs), then selects the current state's row the same way and expands the
+ * index back to one-hot. Returns one bit per character: 1 iff a non-empty
+ * match ends there.
+ * Per character: Q*S*w + Q*w ANDs for the lookup, about Q for the expansion
+ * and Q for the accept bit, with Q states, S symbols and w = log2(Q). */
+inline std::vector<Bit> dfa_match_ends(const SecretDfa & dfa, const OneHotString & text) {
+	if(dfa.num_symbols != text.num_symbols)
+		error("DFA and text use different alphabets\n");
+	int Q = dfa.num_states, S = dfa.num_symbols, w = dfa.width;
+	std::vector<Bit> state, index(w), res;
+	for(int i = 0; i < text.size(); ++i) {
+		const Bit * c = text[i];
+		for(int j = 0; j < w; ++j)
+			index[j] = Bit(false, PUBLIC);
+		// the initial state is public: only row 0 is needed
+		for(int q = 0; q < (i == 0 ? 1 : Q); ++q)
+			for(int j = 0; j < w; ++j) {
+				const Bit * t = dfa.next.data() + q*S*w + j;
+				Bit row = c[0] & t[0];
+				for(int a = 1; a < S; ++a)
+					row = row ^ (c[a] & t[a*w]);
+				index[j] = index[j] ^ (i == 0 ? row : state[q] & row);
+			}
+		state = one_hot(index, Q);
+		Bit acc = state[0] & dfa.accept[0];
+		for(int q = 1; q < Q; ++q)
+			acc = acc ^ (state[q] & dfa.accept[q]);
+		res.push_back(acc);
+	}
+	return res;
+}
+
+// 1 iff the regex of dfa matches a non-empty substring of text
+inline Bit dfa_find_match(const SecretDfa & dfa, const OneHotString & text) {
+	return or_tree(dfa_match_ends(dfa, text));
+}
+
+}
+#endif
@@ -2,24 +2,92 @@
 #define EMP_SEMIHONEST_H__
 #include "emp-sh2pc/sh_gen.h"
 #include "emp-sh2pc/sh_eva.h"
+#include <fstream>
 
 namespace emp {
 
+/* HalfGateGen or HalfGateEva of a SemiHonestParty: flushes the party's
+ * deferred inputs before the first gate after them, so both parties exchange
+ * the corrections at the same point of the circuit, and counts XOR gates for
+ * the party's stats. */
+template<typename IO, template<typename> class GC>
+class SemiHonestGates: public GC<IO> { public:
+	SemiHonestParty<IO> * party = nullptr;
+
+	SemiHonestGates(IO * io) : GC<IO>(io) {}
+
+	block and_gate(const block & a, const block & b) override {
+		if(party->num_pending != 0)
+			party->flush_inputs();
+		return GC<IO>::and_gate(a, b);
+	}
+
+	block xor_gate(const block & a, const block & b) override {
+		if(party->num_pending != 0)
+			party->flush_inputs();
+		++party->counted.num_xor;
+		return GC<IO>::xor_gate(a, b);
+	}
+
+	block not_gate(const block & a) override {
+		if(party->num_pending != 0)
+			party->flush_inputs();
+		return GC<IO>::not_gate(a);
+	}
+};
+
 template<typename IO>
-inline SemiHonestParty<IO>* setup_semi_honest(IO* io, int party, int batch_size = 1024*16) {
+inline SemiHonestParty<IO>* setup_party(IO* io, int party, CotPool * pool, int ot_type, BaseOTCache * cache, int batch_size = 1024*16) {
+	SemiHonestParty<IO> * ctx;
+	// the gate object sends its setup before the party counts any traffic
+	uint64_t counter = io->counter, gate_sent;
 	if(party == ALICE) {
-		HalfGateGen<IO> * t = new HalfGateGen<IO>(io);
+		SemiHonestGates<IO, HalfGateGen> * t = new SemiHonestGates<IO, HalfGateGen>(io);
+		gate_sent = io->counter - counter;
 		CircuitExecution::circ_exec = t;
-		ProtocolExecution::prot_exec = new SemiHonestGen<IO>(io, t);
+		t->party = ctx = new SemiHonestGen<IO>(io, t, pool, ot_type, cache, batch_size);
 	} else {
-		HalfGateEva<IO> * t = new HalfGateEva<IO>(io);
+		SemiHonestGates<IO, HalfGateEva> * t = new SemiHonestGates<IO, HalfGateEva>(io);
+		gate_sent = io->counter - counter;
 		CircuitExecution::circ_exec = t;
-		ProtocolExecution::prot_exec = new SemiHonestEva<IO>(io, t);
+		t->party = ctx = new SemiHonestEva<IO>(io, t, pool, ot_type, cache, batch_size);
 	}
-	return (SemiHonestParty<IO>*)ProtocolExecution::prot_exec;
+	ctx->counted.bytes_sent[PHASE_BASE_OT] += gate_sent;
+	ProtocolExecution::prot_exec = ctx;
+	return ctx;
+}
+
+/* With defer_inputs, BOB's inputs are coalesced into one message per run of
+ * feeds, see DeferredInputs in sh_party.h. */
+template<typename IO>
+inline SemiHonestParty<IO>* setup_semi_honest(IO* io, int party, int batch_size = 1024*16, int ot_type = IKNP_OT, bool defer_inputs = false) {
+	SemiHonestParty<IO> * ctx = setup_party(io, party, nullptr, ot_type, nullptr, batch_size);
+	ctx->defer = defer_inputs;
+	return ctx;
+}
+
+/* Online phase for COTs from precompute_cot_pool(): feed() is served from
+ * cot_pool, and the garbling delta is the one the pool was extended under. */
+template<typename IO>
+inline SemiHonestParty<IO>* setup_semi_honest(IO* io, int party, const char * cot_pool) {
+	return setup_party(io, party, new CotPool(cot_pool, party), IKNP_OT, nullptr);
 }
 
-inline void finalize_semi_honest() {
+/* IKNP base OTs are taken from cache when the peer holds the matching one,
+ * otherwise they are run and saved to it. */
+template<typename IO>
+inline SemiHonestParty<IO>* setup_semi_honest(IO* io, int party, BaseOTCache * cache) {
+	return setup_party(io, party, nullptr, IKNP_OT, cache);
+}
+
+/* With stats_json, both parties exchange their PartyStats first and each
+ * writes its own, with bytes received per phase, as JSON to that file. */
+inline void finalize_semi_honest(const char * stats_json = nullptr) {
+	PhaseCounter * counter = dynamic_cast<PhaseCounter*>(ProtocolExecution::prot_exec);
+	if(stats_json != nullptr and counter != nullptr) {
+		std::ofstream out(stats_json);
+		out << counter->exchange_stats().json() << std::endl;
+	}
 	delete CircuitExecution::circ_exec;
 	delete ProtocolExecution::prot_exec;
 }
@@ -0,0 +1,121 @@
+#ifndef EMP_SH_BASE_OT_CACHE_H__
+#define EMP_SH_BASE_OT_CACHE_H__
+#include "emp-tool/emp-tool.h"
+#include <fstream>
+#include <string>
+
+namespace emp {
+
+/* Base-OT results for IKNP, kept in a local file encrypted under key and
+ * bound to the peer's identity, so a restarted party can skip the public-key
+ * base OTs. ALICE stores delta and k_{s_i}, BOB stores k0_i and k1_i.
+ * Reusing the cache keeps ALICE's delta across sessions; every session
+ * derives fresh IKNP seeds from the cached keys and a joint nonce. */
+class BaseOTCache { public:
+	struct Content {
+		block id;
+		block delta;
+		block k0[128];
+		block k1[128];
+		int64_t party;
+	};
+
+	std::string file;
+	std::string peer;
+	block key;
+	Content data;
+	bool valid = false;
+
+	BaseOTCache(const std::string & file, const std::string & peer, const block & key) {
+		this->file = file;
+		this->peer = peer;
+		this->key = key;
+		load();
+	}
+
+	/* Loads the cache; a missing file, wrong key or wrong peer leaves it invalid. */
+	bool load() {
+		valid = false;
+		std::ifstream in(file, std::ios::binary);
+		block iv;
+		char tag[Hash::DIGEST_SIZE];
+		if(!in.read((char *)&iv, sizeof(block)) or !in.read(tag, Hash::DIGEST_SIZE)
+			or !in.read((char *)&data, sizeof(Content)))
+			return false;
+		crypt(iv);
+		char expected[Hash::DIGEST_SIZE];
+		mac(expected, iv);
+		valid = (memcmp(tag, expected, Hash::DIGEST_SIZE) == 0);
+		return valid;
+	}
+
+	void store(int party, const block & id, const block & delta, const block * k0, const block * k1) {
+		data.id = id;
+		data.delta = delta;
+		data.party = party;
+		memcpy(data.k0, k0, 128*sizeof(block));
+		if(k1 != nullptr)
+			memcpy(data.k1, k1, 128*sizeof(block));
+		else memset(data.k1, 0, 128*sizeof(block));
+		valid = true;
+
+		block iv;
+		PRG prg;
+		prg.random_block(&iv, 1);
+		char tag[Hash::DIGEST_SIZE];
+		mac(tag, iv);
+		crypt(iv);
+		std::ofstream out(file, std::ios::binary | std::ios::trunc);
+		out.write((char *)&iv, sizeof(block));
+		out.write(tag, Hash::DIGEST_SIZE);
+		out.write((char *)&data, sizeof(Content));
+		crypt(iv);
+		if(!out)
+			error("cannot write base OT cache\n");
+	}
+
+	/* Fresh seeds for one session: out[i] = H(in[i], nonce, i). */
+	static void derive(block * out, const block * in, const block & nonce) {
+		char dgst[Hash::DIGEST_SIZE];
+		for(int i = 0; i < 128; ++i) {
+			block tmp[2] = {in[i], nonce ^ makeBlock(0, i)};
+			Hash::hash_once(dgst, tmp, sizeof(tmp));
+			memcpy(&out[i], dgst, sizeof(block));
+		}
+	}
+
+	// XORs data with a keystream bound to key, peer and iv.
+	void crypt(const block & iv) {
+		block seed = stream_seed(iv);
+		PRG prg(&seed);
+		block * pad = new block[sizeof(Content)/sizeof(block) + 1];
+		prg.random_block(pad, sizeof(Content)/sizeof(block) + 1);
+		char * p = (char *)&data, * q = (char *)pad;
+		for(size_t i = 0; i < sizeof(Content); ++i)
+			p[i] ^= q[i];
+		delete[] pad;
+	}
+
+	void mac(char * tag, const block & iv) {
+		std::string buf((char *)&key, sizeof(block));
+		buf.append((char *)&iv, sizeof(block));
+		buf.append(peer);
+		buf.append((char *)&data, sizeof(Content));
+		Hash::hash_once(tag, buf.data(), buf.size());
+	}
+
+	block stream_seed(const block & iv) {
+		std::string buf((char *)&key, sizeof(block));
+		buf.append((char *)&iv, sizeof(block));
+		buf.append(peer);
+		buf.append("stream");
+		char dgst[Hash::DIGEST_SIZE];
+		Hash::hash_once(dgst, buf.data(), buf.size());
+		block seed;
+		memcpy(&seed, dgst, sizeof(block));
+		return seed;
+	}
+};
+
+}
+#endif
@@ -0,0 +1,142 @@
+#ifndef EMP_SH_BATCH_H__
+#define EMP_SH_BATCH_H__
+#include "emp-tool/emp-tool.h"
+#include "emp-sh2pc/sh_party.h"
+#include <type_traits>
+#include <vector>
+
+namespace emp {
+
+/* Batch reveal: labels of all values are gathered into one array and opened
+ * by a single call to ProtocolExecution::reveal, so the whole vector costs one
+ * bit-packed message (two for PUBLIC) instead of one round trip per value. */
+inline std::vector<bool> reveal_batch(const std::vector<Bit> & in, int party = PUBLIC) {
+	bool * b = new bool[in.size()];
+	flush_inputs();
+	ProtocolExecution::prot_exec->reveal(b, party, (const block *)in.data(), in.size());
+	std::vector<bool> res(b, b + in.size());
+	delete[] b;
+	return res;
+}
+
+template<typename T = int64_t>
+inline std::vector<T> reveal_batch(const std::vector<Integer> & in, int party = PUBLIC) {
+	size_t total = 0;
+	for (const auto & v : in)
+		total += v.size();
+	flush_inputs();
+	block * label = new block[total];
+	bool * b = new bool[total];
+	size_t pos = 0;
+	for (const auto & v : in) {
+		memcpy(label + pos, v.bits.data(), v.size() * sizeof(block));
+		pos += v.size();
+	}
+	ProtocolExecution::prot_exec->reveal(b, party, label, total);
+
+	std::vector<T> res(in.size());
+	pos = 0;
+	for (size_t i = 0; i < in.size(); ++i) {
+		int len = in[i].size();
+		// shifts into the sign bit of T are undefined, so build it unsigned
+		uint64_t v = 0;
+		for (int j = 0; j < len and j < (int)sizeof(T)*8; ++j)
+			if (b[pos + j])
+				v |= (uint64_t)1 << j;
+		// Integer is two's complement, sign extend short values
+		if (std::is_signed<T>::value and len > 0 and len < (int)sizeof(T)*8 and b[pos + len - 1])
+			v |= ~(uint64_t)0 << len;
+		res[i] = (T)v;
+		pos += len;
+	}
+	delete[] label;
+	delete[] b;
+	return res;
+}
+
+// b[8i .. 8i+7] = bits of byte i, LSB first, one 64-bit store per byte
+inline void unpack_bytes(bool * b, const uint8_t * data, size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+#if defined(__BMI2__)
+		uint64_t t = _pdep_u64(data[i], 0x0101010101010101ULL);
+#else
+		uint64_t t = data[i] * 0x0101010101010101ULL & 0x8040201008040201ULL;
+		t = ((t + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
+#endif
+		memcpy(b + 8*i, &t, 8);
+	}
+}
+
+/* width bools per value, LSB first: two's complement as in Integer, sign
+ * extended (zero extended for unsigned T) or truncated to width. */
+template<typename T>
+inline void unpack_values(bool * b, const T * data, size_t n, int width) {
+	static_assert(std::is_integral<T>::value, "unpack_values needs an integral type");
+	if (width == (int)sizeof(T)*8) {
+		unpack_bytes(b, (const uint8_t *)data, n*sizeof(T));
+		return;
+	}
+	for (size_t i = 0; i < n; ++i) {
+		uint64_t v = (uint64_t)data[i];
+		bool * out = b + (size_t)width*i;
+		if (width % 8 == 0 and width <= 64)
+			unpack_bytes(out, (const uint8_t *)&v, width/8);
+		else for (int j = 0; j < width; ++j)
+			out[j] = j < 64 ? (v >> j) & 1 : data[i] < 0;
+	}
+}
+
+// n labels of party's bits b from one feed(), or public labels
+inline void feed_labels(block * label, const bool * b, size_t n, int party) {
+	if (n == 0)
+		return;
+	if (party == PUBLIC) {
+		block zero = CircuitExecution::circ_exec->public_label(false);
+		block one = CircuitExecution::circ_exec->public_label(true);
+		for (size_t i = 0; i < n; ++i)
+			label[i] = b[i] ? one : zero;
+	} else ProtocolExecution::prot_exec->feed(label, party, b, n);
+}
+
+/* Batch input: n values of width bits as one contiguous label block from a
+ * single call to feed(), split into Integers afterwards, instead of one
+ * feed() per Integer constructor. Only the party holding data (or everyone,
+ * for PUBLIC) needs to pass it; the other one passes nullptr. */
+template<typename T>
+inline std::vector<Integer> feed_batch(const T * data, size_t n, int width, int party) {
+	size_t total = n*width;
+	bool * b = new bool[total];
+	if (data != nullptr)
+		unpack_values(b, data, n, width);
+	else memset(b, false, total);
+	block * label = new block[total];
+	feed_labels(label, b, total, party);
+	std::vector<Integer> res(n);
+	for (size_t i = 0; i < n; ++i)
+		res[i].bits.assign((Bit *)label + i*width, (Bit *)label + (i+1)*width);
+	move_inputs(label, total, [&](size_t i) { return (block *)res[i/width].bits.data() + i%width; });
+	delete[] label;
+	delete[] b;
+	return res;
+}
+
+// As above for 32-bit IEEE floats, bit i of Float is bit i of the float
+inline std::vector<Float> feed_batch(const float * data, size_t n, int party) {
+	size_t total = n*32;
+	bool * b = new bool[total];
+	if (data != nullptr)
+		unpack_bytes(b, (const uint8_t *)data, n*sizeof(float));
+	else memset(b, false, total);
+	block * label = new block[total];
+	feed_labels(label, b, total, party);
+	std::vector<Float> res(n);
+	for (size_t i = 0; i < n; ++i)
+		res[i].value.assign((Bit *)label + i*32, (Bit *)label + (i+1)*32);
+	move_inputs(label, total, [&](size_t i) { return (block *)res[i/32].value.data() + i%32; });
+	delete[] label;
+	delete[] b;
+	return res;
+}
+
+}
+#endif
@@ -0,0 +1,126 @@
+#ifndef EMP_SH_COT_POOL_H__
+#define EMP_SH_COT_POOL_H__
+#include "emp-tool/emp-tool.h"
+#include "emp-ot/emp-ot.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace emp {
+
+/* Correlated OTs extended ahead of time and kept in a memory-mapped file, one
+ * per party. ALICE stores K_i and delta, BOB stores K_i ^ r_i*delta and r_i.
+ * The consumed prefix is persisted in the header before the COTs are handed
+ * out, so no COT is ever served twice, even across crashes. */
+class CotPool { public:
+	struct Header {
+		uint64_t magic;
+		int64_t party;
+		int64_t num;
+		int64_t used;
+		block delta;
+		block id;
+	};
+	static const uint64_t MAGIC = 0x6c6f6f70746f6373ULL;
+
+	Header * header = nullptr;
+	block * data = nullptr;
+	bool * choice = nullptr;
+	size_t file_size = 0;
+
+	static size_t size_of(int64_t num) {
+		return sizeof(Header) + num*(sizeof(block) + sizeof(bool));
+	}
+
+	/* Creates a pool file holding num COTs, to be filled by the caller. */
+	CotPool(const char * file, int party, int64_t num) {
+		map(file, size_of(num), true);
+		header->magic = MAGIC;
+		header->party = party;
+		header->num = num;
+		header->used = 0;
+	}
+
+	/* Opens an existing pool file. */
+	CotPool(const char * file, int party) {
+		struct stat st;
+		if(stat(file, &st) != 0 or (size_t)st.st_size < sizeof(Header))
+			error("cannot open COT pool\n");
+		map(file, st.st_size, false);
+		if(header->magic != MAGIC or header->party != party
+			or size_of(header->num) != file_size)
+			error("invalid COT pool\n");
+	}
+
+	~CotPool() {
+		msync(header, file_size, MS_SYNC);
+		munmap(header, file_size);
+	}
+
+	int64_t remaining() const {
+		return header->num - header->used;
+	}
+
+	/* Hands out the next length COTs; choice is only written for BOB. */
+	void next(block * out, bool * out_choice, int64_t length) {
+		if(length > remaining())
+			error("COT pool exhausted\n");
+		int64_t start = header->used;
+		header->used += length;
+		msync(header, sizeof(Header), MS_SYNC);
+		memcpy(out, data + start, length*sizeof(block));
+		if(out_choice != nullptr)
+			memcpy(out_choice, choice + start, length);
+	}
+
+	void map(const char * file, size_t size, bool create) {
+		int fd = create ? open(file, O_RDWR | O_CREAT | O_TRUNC, 0600) : open(file, O_RDWR);
+		if(fd < 0)
+			error("cannot open COT pool\n");
+		if(create and ftruncate(fd, size) != 0)
+			error("cannot resize COT pool\n");
+		void * ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if(ptr == MAP_FAILED)
+			error("cannot map COT pool\n");
+		file_size = size;
+		header = (Header *)ptr;
+		data = (block *)(header + 1);
+		choice = (bool *)(data + (size - sizeof(Header))/(sizeof(block) + sizeof(bool)));
+	}
+};
+
+/* Offline phase: runs IKNP for num COTs under a fresh delta and writes them to
+ * file. Both parties call it at the same time over io. */
+template<typename IO>
+inline void precompute_cot_pool(IO * io, int party, const char * file, int64_t num, int64_t chunk = 1<<20) {
+	CotPool pool(file, party, num);
+	IKNP<IO> ot(io);
+	if(party == ALICE) {
+		PRG prg;
+		prg.random_block(&pool.header->delta, 1);
+		pool.header->delta = pool.header->delta | makeBlock(0x0, 0x1);
+		prg.random_block(&pool.header->id, 1);
+		bool delta_bool[128];
+		block_to_bool(delta_bool, pool.header->delta);
+		ot.setup_send(delta_bool);
+		io->send_block(&pool.header->id, 1);
+		for(int64_t i = 0; i < num; i += chunk)
+			ot.send_cot(pool.data + i, std::min(chunk, num - i));
+	} else {
+		PRG prg;
+		pool.header->delta = zero_block;
+		ot.setup_recv();
+		io->recv_block(&pool.header->id, 1);
+		for(int64_t i = 0; i < num; i += chunk) {
+			int64_t n = std::min(chunk, num - i);
+			prg.random_bool(pool.choice + i, n);
+			ot.recv_cot(pool.data + i, pool.choice + i, n);
+		}
+	}
+	io->flush();
+}
+
+}
+#endif
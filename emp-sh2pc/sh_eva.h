@@ -7,28 +7,76 @@ template<typename IO>
 class SemiHonestEva: public SemiHonestParty<IO> { public:
 	HalfGateEva<IO> * gc;
 	PRG prg;
-	SemiHonestEva(IO *io, HalfGateEva<IO> * gc): SemiHonestParty<IO>(io, BOB) {
+	SemiHonestEva(IO *io, HalfGateEva<IO> * gc, CotPool * pool = nullptr, int ot_type = IKNP_OT, BaseOTCache * cache = nullptr, int batch_size = 1024*16): SemiHonestParty<IO>(io, BOB, ot_type, batch_size) {
 		this->gc = gc;	
-		this->ot->setup_recv();
+		this->circ = gc;
+		this->pool = pool;
+		if(pool != nullptr) {
+			gc->set_delta();
+			block id;
+			int64_t used;
+			this->io->recv_block(&id, 1);
+			this->io->recv_data(&used, sizeof(int64_t));
+			if(!cmpBlock(&id, &pool->header->id, 1) or used != pool->header->used)
+				error("COT pool does not match the peer's\n");
+		} else if(cache != nullptr) {
+			if(this->setup_ot_cached(cache, nullptr))
+				gc->set_delta();
+		} else
+			this->setup_ot(this->ot, nullptr);
 		block seed; this->io->recv_block(&seed, 1);
 		this->shared_prg.reseed(&seed);
+		this->draw_gate_key();
 		refill();
+		this->enter(PHASE_GATES);
 	}
 
 	void refill() {
-		prg.random_bool(this->buff, this->batch_size);
-		this->ot->recv_cot(this->buf, this->buff, this->batch_size);
+		int prev = this->enter(PHASE_OT_EXTENSION);
+		if(!this->refill_prepared())
+			this->extend(this->ot, &prg, this->buf, this->buff, this->batch_size);
 		this->top = 0;
+		this->enter(prev);
+	}
+
+	void reset() override {
+		this->drop_inputs();
+		int prev = this->enter(PHASE_BASE_OT);
+		gc->set_delta();
+		block seed;
+		this->io->recv_block(&seed, 1);
+		this->shared_prg.reseed(&seed);
+		this->draw_gate_key();
+		this->enter(prev);
+	}
+
+	void enable_async_refill(IO * ot_io) override {
+		this->async_io = ot_io;
+		int prev = this->enter(PHASE_BASE_OT);
+		uint64_t sent = ot_io->counter;
+		COT<IO> * ot2 = this->new_ot(&this->async_io);
+		this->setup_ot(ot2, nullptr);
+		ot_io->flush();
+		this->counted.bytes_sent[PHASE_BASE_OT] += ot_io->counter - sent;
+		this->enter(prev);
+		this->start_async_refill(ot_io, ot2);
 	}
 
 	void feed(block * label, int party, const bool* b, int length) {
+		int prev = this->enter(PHASE_FEED);
 		if(party == ALICE) {
 			this->shared_prg.random_block(label, length);
 		} else {
-			if (length > this->batch_size) {
+			if (length > this->batch_size and this->pool != nullptr) {
+				for (int i = 0; i < length; i += this->batch_size)
+					feed(label + i, party, b + i, std::min(this->batch_size, length - i));
+			} else if (length > this->batch_size) {
+				this->enter(PHASE_OT_EXTENSION);
+				this->counted.num_cot += length;
 				this->ot->recv_cot(label, b, length);
 			} else {
-				bool * tmp = new bool[length];
+				bool * tmp = this->scratch;
+				this->counted.num_cot += length;
 				if(length > this->batch_size - this->top) {
 					memcpy(label, this->buf + this->top, (this->batch_size-this->top)*sizeof(block));
 					memcpy(tmp, this->buff + this->top, (this->batch_size-this->top));
@@ -45,31 +93,48 @@ class SemiHonestEva: public SemiHonestParty<IO> { public:
 
 				for(int i = 0; i < length; ++i)
 					tmp[i] = (tmp[i] != b[i]); 
-				this->io->send_data(tmp, length);
-
-				delete[] tmp;
+				if(this->defer) {
+					bool * d = this->pending_buffer(this->num_pending + length);
+					memcpy(d + this->num_pending, tmp, length);
+					this->num_pending += length;
+				} else this->io->send_bool(tmp, length);
 			}
 		}
+		this->enter(prev);
+	}
+
+	void flush_inputs() override {
+		if(this->num_pending == 0)
+			return;
+		int prev = this->enter(PHASE_FEED);
+		this->io->send_bool(this->pending, this->num_pending);
+		this->io->flush();
+		this->num_pending = 0;
+		this->enter(prev);
 	}
 
 	void reveal(bool * b, int party, const block * label, int length) {
+		flush_inputs();
 		if (party == XOR) {
 			for (int i = 0; i < length; ++i)
 				b[i] = getLSB(label[i]);
 			return;
 		}
-		for (int i = 0; i < length; ++i) {
-			bool lsb = getLSB(label[i]), tmp;
-			if (party == BOB or party == PUBLIC) {
-				this->io->recv_data(&tmp, 1);
-				b[i] = (tmp != lsb);
-			} else if (party == ALICE) {
-				this->io->send_data(&lsb, 1);
-				b[i] = false;
-			}
+		int prev = this->enter(PHASE_REVEAL);
+		bool * t = this->wire_buffer(length);
+		if (party == BOB or party == PUBLIC) {
+			this->io->recv_bool(t, length);
+			for (int i = 0; i < length; ++i)
+				b[i] = t[i] = (t[i] != getLSB(label[i]));
+			if(party == PUBLIC)
+				this->io->send_bool(t, length);
+		} else if (party == ALICE) {
+			for (int i = 0; i < length; ++i)
+				t[i] = getLSB(label[i]);
+			this->io->send_bool(t, length);
+			memset(b, false, length);
 		}
-		if(party == PUBLIC)
-			this->io->send_data(b, length);
+		this->enter(prev);
 	}
 
 };
@@ -7,25 +7,68 @@ namespace emp {
 template<typename IO>
 class SemiHonestGen: public SemiHonestParty<IO> { public:
 	HalfGateGen<IO> * gc;
-	SemiHonestGen(IO* io, HalfGateGen<IO>* gc): SemiHonestParty<IO>(io, ALICE) {
+	SemiHonestGen(IO* io, HalfGateGen<IO>* gc, CotPool * pool = nullptr, int ot_type = IKNP_OT, BaseOTCache * cache = nullptr, int batch_size = 1024*16): SemiHonestParty<IO>(io, ALICE, ot_type, batch_size) {
 		this->gc = gc;
-		bool delta_bool[128];
-		block_to_bool(delta_bool, gc->delta);
-		this->ot->setup_send(delta_bool);
+		this->circ = gc;
+		this->pool = pool;
+		if(pool != nullptr) {
+			gc->set_delta(pool->header->delta);
+			this->io->send_block(&pool->header->id, 1);
+			this->io->send_data(&pool->header->used, sizeof(int64_t));
+		} else if(cache != nullptr) {
+			block delta = gc->delta;
+			if(this->setup_ot_cached(cache, &delta))
+				gc->set_delta(delta);
+		} else
+			this->setup_ot(this->ot, &gc->delta);
 		block seed;
 		PRG prg;
 		prg.random_block(&seed, 1);
 		this->io->send_block(&seed, 1);
 		this->shared_prg.reseed(&seed);
+		this->draw_gate_key();
 		refill();
+		this->enter(PHASE_GATES);
 	}
 
 	void refill() {
-		this->ot->send_cot(this->buf, this->batch_size);
+		int prev = this->enter(PHASE_OT_EXTENSION);
+		if(!this->refill_prepared())
+			this->extend(this->ot, nullptr, this->buf, this->buff, this->batch_size);
 		this->top = 0;
+		this->enter(prev);
+	}
+
+	void reset() override {
+		this->drop_inputs();
+		int prev = this->enter(PHASE_BASE_OT);
+		gc->set_delta(gc->delta);
+		block seed;
+		PRG prg;
+		prg.random_block(&seed, 1);
+		this->io->send_block(&seed, 1);
+		this->shared_prg.reseed(&seed);
+		this->draw_gate_key();
+		this->io->flush();
+		this->enter(prev);
+	}
+
+	/* Moves COT extension off the critical path: ot_io must be a second
+	 * channel to the same peer, which calls enable_async_refill too. */
+	void enable_async_refill(IO * ot_io) override {
+		this->async_io = ot_io;
+		int prev = this->enter(PHASE_BASE_OT);
+		uint64_t sent = ot_io->counter;
+		COT<IO> * ot2 = this->new_ot(&this->async_io);
+		this->setup_ot(ot2, &gc->delta);
+		ot_io->flush();
+		this->counted.bytes_sent[PHASE_BASE_OT] += ot_io->counter - sent;
+		this->enter(prev);
+		this->start_async_refill(ot_io, ot2);
 	}
 
 	void feed(block * label, int party, const bool* b, int length) {
+		int prev = this->enter(PHASE_FEED);
 		if(party == ALICE) {
 			this->shared_prg.random_block(label, length);
 			for (int i = 0; i < length; ++i) {
@@ -33,10 +76,16 @@ class SemiHonestGen: public SemiHonestParty<IO> { public:
 					label[i] = label[i] ^ gc->delta;
 			}
 		} else {
-			if (length > this->batch_size) {
+			if (length > this->batch_size and this->pool != nullptr) {
+				for (int i = 0; i < length; i += this->batch_size)
+					feed(label + i, party, b + i, std::min(this->batch_size, length - i));
+			} else if (length > this->batch_size) {
+				this->enter(PHASE_OT_EXTENSION);
+				this->counted.num_cot += length;
 				this->ot->send_cot(label, length);
 			} else {
-				bool * tmp = new bool[length];
+				bool * tmp = this->scratch;
+				this->counted.num_cot += length;
 				if(length > this->batch_size - this->top) {
 					memcpy(label, this->buf + this->top, (this->batch_size-this->top)*sizeof(block));
 					int filled = this->batch_size - this->top;
@@ -47,35 +96,61 @@ class SemiHonestGen: public SemiHonestParty<IO> { public:
 					memcpy(label, this->buf+this->top, length*sizeof(block));
 					this->top+=length;
 				}
-				
-				this->io->recv_data(tmp, length);
-				for (int i = 0; i < length; ++i)
-					if(tmp[i])
-						label[i] = label[i] ^ gc->delta;
-				delete[] tmp;
+
+				if(this->defer) {
+					this->pending_labels.emplace_back(label, length);
+					this->num_pending += length;
+				} else {
+					this->io->recv_bool(tmp, length);
+					for (int i = 0; i < length; ++i)
+						if(tmp[i])
+							label[i] = label[i] ^ gc->delta;
+				}
 			}
 		}
+		this->enter(prev);
+	}
+
+	void flush_inputs() override {
+		if(this->num_pending == 0)
+			return;
+		int prev = this->enter(PHASE_FEED);
+		bool * d = this->pending_buffer(this->num_pending);
+		this->io->recv_bool(d, this->num_pending);
+		for(auto & p : this->pending_labels) {
+			for (int i = 0; i < p.second; ++i)
+				if(d[i])
+					p.first[i] = p.first[i] ^ gc->delta;
+			d += p.second;
+		}
+		this->pending_labels.clear();
+		this->num_pending = 0;
+		this->enter(prev);
 	}
 
 	void reveal(bool* b, int party, const block * label, int length) {
+		flush_inputs();
 		if (party == XOR) {
 			for (int i = 0; i < length; ++i)
 				b[i] = getLSB(label[i]);
 			return;
 		}
-		for (int i = 0; i < length; ++i) {
-			bool lsb = getLSB(label[i]);
-			if (party == BOB or party == PUBLIC) {
-				this->io->send_data(&lsb, 1);
-				b[i] = false;
-			} else if(party == ALICE) {
-				bool tmp;
-				this->io->recv_data(&tmp, 1);
-				b[i] = (tmp != lsb);
-			}
+		int prev = this->enter(PHASE_REVEAL);
+		bool * t = this->wire_buffer(length);
+		if (party == BOB or party == PUBLIC) {
+			for (int i = 0; i < length; ++i)
+				t[i] = getLSB(label[i]);
+			this->io->send_bool(t, length);
+			if(party == PUBLIC) {
+				this->io->recv_bool(t, length);
+				memcpy(b, t, length);
+			} else memset(b, false, length);
+		} else if(party == ALICE) {
+			this->io->recv_bool(t, length);
+			for (int i = 0; i < length; ++i)
+				b[i] = (t[i] != getLSB(label[i]));
 		}
-		if(party == PUBLIC)
-			this->io->recv_data(b, length);
+		this->enter(prev);
 	}
 };
 }
@@ -0,0 +1,107 @@
+#ifndef EMP_SH_PARALLEL_H__
+#define EMP_SH_PARALLEL_H__
+#include "emp-sh2pc/semihonest.h"
+#include <thread>
+#include <vector>
+
+namespace emp {
+#ifdef THREADING
+/* K garbling instances over K extra channels, one per worker thread. All of
+ * them garble under the delta of the calling thread's execution, so labels
+ * move freely between workers and the caller: inputs fed on the caller can be
+ * used by workers and their outputs merged back on the caller. The AND and
+ * XOR gates of the workers are added to the caller's PartyStats after every
+ * run().
+ * Needs emp-tool built with THREADING, which makes circ_exec and prot_exec
+ * thread-local. */
+template<typename IO>
+class ParallelSemiHonest { public:
+	int party, threads;
+	IO * caller_io;
+	SemiHonestParty<IO> * caller;
+	std::vector<IO*> ios;
+	std::vector<CircuitExecution*> circ;
+	std::vector<SemiHonestParty<IO>*> prot;
+	std::vector<uint64_t> last_and, last_xor;	// gates of worker i already added to caller
+
+	// Call after setup_semi_honest() on the calling thread; ios are not owned.
+	ParallelSemiHonest(int party, IO ** ios, int threads)
+		: party(party), threads(threads), ios(ios, ios + threads), circ(threads), prot(threads),
+		last_and(threads, 0), last_xor(threads, 0) {
+		caller = (SemiHonestParty<IO>*)ProtocolExecution::prot_exec;
+		caller_io = caller->io;
+		block delta = zero_block;
+		if(party == ALICE)
+			delta = ((HalfGateGen<IO>*)CircuitExecution::circ_exec)->delta;
+		spawn([this, delta](int i) {
+			if(this->party == ALICE) {
+				SemiHonestGates<IO, HalfGateGen> * t = new SemiHonestGates<IO, HalfGateGen>(this->ios[i]);
+				t->set_delta(delta);
+				circ[i] = t;
+				t->party = prot[i] = new SemiHonestGen<IO>(this->ios[i], t);
+			} else {
+				SemiHonestGates<IO, HalfGateEva> * t = new SemiHonestGates<IO, HalfGateEva>(this->ios[i]);
+				t->set_delta();
+				circ[i] = t;
+				t->party = prot[i] = new SemiHonestEva<IO>(this->ios[i], t);
+			}
+			this->ios[i]->flush();
+		});
+	}
+
+	~ParallelSemiHonest() {
+		for(int i = 0; i < threads; ++i) {
+			delete circ[i];
+			delete prot[i];
+		}
+	}
+
+	/* Runs f(i) on worker i with instance i installed; both parties must
+	 * issue the same gates and inputs per worker. */
+	template<typename F>
+	void run(F f) {
+		// the peer's caller may still wait on inputs we have buffered
+		caller_io->flush();
+		spawn([this, &f](int i) {
+			CircuitExecution::circ_exec = circ[i];
+			ProtocolExecution::prot_exec = prot[i];
+			f(i);
+			this->ios[i]->flush();
+		});
+		for(int i = 0; i < threads; ++i) {
+			uint64_t ands = circ[i]->num_and(), xors = prot[i]->counted.num_xor;
+			caller->counted.num_and += ands - last_and[i];
+			caller->counted.num_xor += xors - last_xor[i];
+			last_and[i] = ands;
+			last_xor[i] = xors;
+		}
+	}
+
+	// Calls f(j) for j in [0, n), split into one contiguous chunk per worker.
+	template<typename F>
+	void parallel_for(int64_t n, F f) {
+		run([this, n, &f](int i) {
+			for(int64_t j = n*i/threads; j < n*(i+1)/threads; ++j)
+				f(j);
+		});
+	}
+
+	uint64_t num_and() {
+		uint64_t res = 0;
+		for(auto c : circ)
+			res += c->num_and();
+		return res;
+	}
+
+	template<typename F>
+	void spawn(F f) {
+		std::vector<std::thread> workers;
+		for(int i = 0; i < threads; ++i)
+			workers.emplace_back(f, i);
+		for(auto & w : workers)
+			w.join();
+	}
+};
+#endif
+}
+#endif
@@ -2,39 +2,418 @@
 #define EMP_SH_PARTY_H__
 #include "emp-tool/emp-tool.h"
 #include "emp-ot/emp-ot.h"
+#include "emp-sh2pc/sh_cot_pool.h"
+#include "emp-sh2pc/sh_base_ot_cache.h"
+#include "emp-sh2pc/sh_stats.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+#include <vector>
 
 namespace emp {
 
+// OT extension backing feed() for BOB's inputs
+enum OTType {
+	IKNP_OT = 0,	// IKNP, cheap setup, 128 bits per COT
+	FERRET_OT = 1,	// silent Ferret COT, sublinear communication, costly setup
+};
+
+/* Deferred BOB inputs. With defer enabled, feed() of BOB's bits hands out
+ * labels from the COT buffer at once and queues the correction bits; all
+ * queued corrections then go from BOB to ALICE in one message at
+ * flush_inputs(), which SemiHonestGates calls before the first gate after
+ * them and reveal() calls before opening anything.
+ *
+ * ALICE's labels of the queued inputs are completed in place at the flush, so
+ * until then they must stay where feed() wrote them: construct the values in
+ * place (emplace_back into reserved storage, ArenaBits, SecretString) and do
+ * not copy their labels before the first gate or flush_inputs(), or tell
+ * move_inputs() where the copies went. */
+class DeferredInputs { public:
+	bool defer = false;
+	bool * pending = nullptr;	// BOB: queued corrections, ALICE: room to receive them
+	int64_t num_pending = 0, pending_size = 0;
+	std::vector<std::pair<block *, int>> pending_labels;	// ALICE: labels to complete
+
+	virtual ~DeferredInputs() {
+		delete[] pending;
+	}
+
+	virtual void flush_inputs() = 0;
+
+	// pending with room for at least n bits, keeping the queued ones
+	bool * pending_buffer(int64_t n) {
+		if(n > pending_size) {
+			pending_size = std::max(n, 2*pending_size);
+			bool * tmp = new bool[pending_size];
+			memcpy(tmp, pending, num_pending);
+			delete[] pending;
+			pending = tmp;
+		}
+		return pending;
+	}
+
+	/* Labels [from, from + n) of the last feed() were copied, label i to
+	 * to(i): queued inputs among them are completed at the copies instead.
+	 * Only the entries of the last feed() are looked at. */
+	template<typename F>
+	void move_inputs(const block * from, size_t n, F to) {
+		size_t first = pending_labels.size();
+		while(first > 0 and pending_labels[first-1].first >= from and pending_labels[first-1].first < from + n)
+			--first;
+		std::vector<std::pair<block *, int>> moved;
+		for(size_t e = first; e < pending_labels.size(); ++e) {
+			size_t pos = pending_labels[e].first - from;
+			for(int i = 0; i < pending_labels[e].second; ++i) {
+				block * t = to(pos + i);
+				if(!moved.empty() and moved.back().first + moved.back().second == t)
+					++moved.back().second;
+				else moved.emplace_back(t, 1);
+			}
+		}
+		pending_labels.resize(first);
+		pending_labels.insert(pending_labels.end(), moved.begin(), moved.end());
+	}
+
+	// Drops queued inputs without sending them, on both parties alike
+	void drop_inputs() {
+		num_pending = 0;
+		pending_labels.clear();
+	}
+};
+
+/* Completes the deferred inputs of the current party now, if it defers any;
+ * both parties call it at the same point. Needed before labels are copied or
+ * used outside circ_exec (e.g. by CircuitReplay or BristolBatch). */
+inline void flush_inputs() {
+	DeferredInputs * d = dynamic_cast<DeferredInputs*>(ProtocolExecution::prot_exec);
+	if(d != nullptr and d->num_pending != 0)
+		d->flush_inputs();
+}
+
+// DeferredInputs::move_inputs() of the current party, if it defers any
+template<typename F>
+inline void move_inputs(const block * from, size_t n, F to) {
+	DeferredInputs * d = dynamic_cast<DeferredInputs*>(ProtocolExecution::prot_exec);
+	if(d != nullptr and d->num_pending != 0)
+		d->move_inputs(from, n, to);
+}
+
 template<typename IO>
-class SemiHonestParty: public ProtocolExecution { public:
+class SemiHonestParty: public ProtocolExecution, public DeferredInputs, public PhaseCounter { public:
 	IO* io = nullptr;
-	IKNP<IO> * ot = nullptr;
+	CircuitExecution * circ = nullptr;	// the HalfGateGen/Eva of this party
+	COT<IO> * ot = nullptr;
+	int ot_type = IKNP_OT;
 	PRG shared_prg;
 
 	block * buf = nullptr;
 	bool * buff = nullptr;
+	bool * scratch = nullptr;
+	bool * wire_bits = nullptr;	// see wire_buffer()
+	int64_t wire_bits_size = 0;
 	int top = 0;
 	int batch_size = 1024*16;
 
-	SemiHonestParty(IO * io, int party) : ProtocolExecution(party) {
+	// Precomputed COTs, served instead of running IKNP online.
+	CotPool * pool = nullptr;
+
+	// Background COT producer, see enable_async_refill() in SemiHonestGen/Eva.
+	IO * async_io = nullptr;
+	COT<IO> * async_ot = nullptr;
+	std::thread * producer = nullptr;
+	std::mutex producer_mtx;
+	std::condition_variable producer_cv;
+	block * next_buf = nullptr;
+	bool * next_buff = nullptr;
+	bool next_ready = false, producer_stop = false;
+
+	uint64_t num_refill = 0;
+	uint64_t num_refill_stall = 0;	// refills that had to wait for the producer
+	double refill_wait = 0;		// total time spent in those waits, in us
+	uint64_t async_sent = 0;	// bytes the producer sent on async_io, under producer_mtx
+	uint64_t async_setup_sent = 0;	// bytes on async_io before the producer started
+
+	// hash key and next gate id of the batched half-gates, see draw_gate_key()
+	AES_KEY gate_key;
+	uint64_t next_gate_id = 0;
+
+	SemiHonestParty(IO * io, int party, int ot_type = IKNP_OT, int batch_size = 1024*16) : ProtocolExecution(party) {
 		this->io = io;
-		ot = new IKNP<IO>(io);
+		this->ot_type = ot_type;
+		this->batch_size = batch_size;
+		last_counter = io->counter;
+		ot = new_ot(&this->io);
 		buf = new block[batch_size];
 		buff = new bool[batch_size];
+		scratch = new bool[batch_size];
 	}
 	void set_batch_size(int size) {
+		if(producer != nullptr)
+			error("set_batch_size must be called before enable_async_refill\n");
 		delete[] buf;
 		delete[] buff;
+		delete[] scratch;
 		batch_size = size;
 		buf = new block[batch_size];
 		buff = new bool[batch_size];
+		scratch = new bool[batch_size];
+		top = batch_size;
 	}
 
 	~SemiHonestParty() {
+		stop_async_refill();
 		delete[] buf;
 		delete[] buff;
+		delete[] scratch;
+		delete[] wire_bits;
+		delete pool;
 		delete ot;
 	}
+
+	/* ios must stay valid while the OT is alive, Ferret keeps the pointer. */
+	COT<IO> * new_ot(IO ** ios) {
+		if(ot_type == FERRET_OT)
+			return new FerretCOT<IO>(cur_party, 1, ios, false, false);
+		return new IKNP<IO>(ios[0]);
+	}
+
+	/* Base OTs for a fresh extension; ALICE passes the garbling delta. */
+	void setup_ot(COT<IO> * cot, const block * delta) {
+		if(ot_type == FERRET_OT) {
+			if(cur_party == ALICE)
+				((FerretCOT<IO>*)cot)->setup(*delta);
+			else ((FerretCOT<IO>*)cot)->setup();
+		} else {
+			if(cur_party == ALICE) {
+				bool delta_bool[128];
+				block_to_bool(delta_bool, *delta);
+				((IKNP<IO>*)cot)->setup_send(delta_bool);
+			} else ((IKNP<IO>*)cot)->setup_recv();
+		}
+	}
+
+	/* IKNP setup from a BaseOTCache: one round trip when both parties hold
+	 * matching caches, otherwise fresh base OTs whose results get cached.
+	 * Returns whether the cache was used, ALICE's delta is then the cached one. */
+	bool setup_ot_cached(BaseOTCache * cache, block * delta) {
+		if(ot_type != IKNP_OT)
+			error("base OT cache requires IKNP\n");
+		bool have = cache->valid and cache->data.party == cur_party, use;
+		block nonce, peer_nonce;
+		PRG prg;
+		prg.random_block(&nonce, 1);
+		if(cur_party == ALICE) {
+			io->send_data(&have, 1);
+			io->send_block(&cache->data.id, 1);
+			io->send_block(&nonce, 1);
+			io->flush();
+			io->recv_data(&use, 1);
+			io->recv_block(&peer_nonce, 1);
+		} else {
+			bool peer_have;
+			block peer_id;
+			io->recv_data(&peer_have, 1);
+			io->recv_block(&peer_id, 1);
+			io->recv_block(&peer_nonce, 1);
+			use = have and peer_have and cmpBlock(&peer_id, &cache->data.id, 1);
+			io->send_data(&use, 1);
+			io->send_block(&nonce, 1);
+			io->flush();
+		}
+		nonce = nonce ^ peer_nonce;
+
+		IKNP<IO> * iknp = (IKNP<IO>*)ot;
+		block k0[128], k1[128];
+		bool s[128];
+		if(cur_party == ALICE) {
+			if(!use) {
+				block_to_bool(s, *delta);
+				OTCO<IO> base(io);
+				base.recv(k0, s, 128);
+				cache->store(ALICE, nonce, *delta, k0, nullptr);
+			}
+			*delta = cache->data.delta;
+			block_to_bool(s, *delta);
+			BaseOTCache::derive(k0, cache->data.k0, nonce);
+			iknp->setup_send(s, k0);
+		} else {
+			if(!use) {
+				prg.random_block(k0, 128);
+				prg.random_block(k1, 128);
+				OTCO<IO> base(io);
+				base.send(k0, k1, 128);
+				cache->store(BOB, nonce, zero_block, k0, k1);
+			}
+			BaseOTCache::derive(k0, cache->data.k0, nonce);
+			BaseOTCache::derive(k1, cache->data.k1, nonce);
+			iknp->setup_recv(k0, k1);
+		}
+		return use;
+	}
+
+	/* Extends length random COTs into data, with BOB's choice bits in choice.
+	 * Ferret produces random COTs natively with the choice bit in the LSB, so
+	 * no derandomization message is needed. */
+	void extend(COT<IO> * cot, PRG * prg, block * data, bool * choice, int64_t length) {
+		if(ot_type == FERRET_OT) {
+			((FerretCOT<IO>*)cot)->rcot(data, length);
+			if(cur_party == BOB)
+				for(int64_t i = 0; i < length; ++i)
+					choice[i] = getLSB(data[i]);
+		} else if(cur_party == ALICE) {
+			cot->send_cot(data, length);
+		} else {
+			prg->random_bool(choice, length);
+			cot->recv_cot(data, choice, length);
+		}
+	}
+
+	virtual void enable_async_refill(IO * ot_io) = 0;
+
+	/* Room for n bits to send or receive. send_bool()/recv_bool() pack the
+	 * bits by the buffer's address mod 8, so both parties must use buffers
+	 * aligned alike rather than the caller's. */
+	bool * wire_buffer(int64_t n) {
+		if(n > wire_bits_size) {
+			delete[] wire_bits;
+			wire_bits_size = std::max(n, 2*wire_bits_size);
+			wire_bits = new bool[wire_bits_size];
+		}
+		return wire_bits;
+	}
+
+	/* Key of the hash of halfgate_garble() and halfgate_eval(), drawn from
+	 * shared_prg right after it is seeded, so both parties get the same one.
+	 * A tweak hashed twice under one key and delta would leak delta; parties
+	 * that reuse a delta (CotPool, BaseOTCache, ParallelSemiHonest workers)
+	 * all get fresh seeds, hence keys of their own. */
+	void draw_gate_key() {
+		block key;
+		shared_prg.random_block(&key, 1);
+		AES_set_encrypt_key(key, &gate_key);
+	}
+
+	/* Ids for n AND gates garbled outside circ under gate_key: every engine
+	 * takes its ids from here, and both parties reserve in the same order.
+	 * Kept across reset(), like delta. */
+	uint64_t reserve_gate_ids(uint64_t n) {
+		uint64_t res = next_gate_id;
+		next_gate_id += n;
+		return res;
+	}
+
+	// Switches the phase traffic and time are charged to, returns the old one
+	int enter(int next) {
+		return switch_phase(next, io->counter);
+	}
+
+	PartyStats stats() override {
+		switch_phase(phase, io->counter);
+		PartyStats s = counted;
+		{
+			std::lock_guard<std::mutex> lock(producer_mtx);
+			s.bytes_sent[PHASE_OT_EXTENSION] += async_sent;
+		}
+		s.num_refill = num_refill;
+		s.num_refill_stall = num_refill_stall;
+		s.num_and += circ->num_and();
+		return s;
+	}
+
+	PartyStats exchange_stats() override {
+		PartyStats s = stats();
+		io->send_data(s.bytes_sent, sizeof(s.bytes_sent));
+		io->flush();
+		io->recv_data(s.bytes_recv, sizeof(s.bytes_recv));
+		last_counter = io->counter;
+		return s;
+	}
+
+	/* Starts a new job on the same connection: draws a fresh shared_prg seed
+	 * and fresh public labels. Delta, the base OTs and unused COTs are kept. */
+	virtual void reset() = 0;
+
+	/* Starts a thread that extends the next batch of COTs with ot2 over its
+	 * own channel while the current batch is consumed. Both parties issue the
+	 * same sequence of refills, so the two producers stay in lockstep. */
+	void start_async_refill(IO * ot_io, COT<IO> * ot2) {
+		if(producer != nullptr)
+			error("async refill already enabled\n");
+		async_io = ot_io;
+		async_ot = ot2;
+		next_buf = new block[batch_size];
+		next_buff = new bool[batch_size];
+		next_ready = false;
+		producer_stop = false;
+		async_sent = 0;
+		async_setup_sent = ot_io->counter;
+		producer = new std::thread([this]() { produce(); });
+	}
+
+	void produce() {
+		PRG prg;
+		std::unique_lock<std::mutex> lock(producer_mtx);
+		while(true) {
+			producer_cv.wait(lock, [this]() { return !next_ready or producer_stop; });
+			if(producer_stop)
+				return;
+			lock.unlock();
+			uint64_t sent = async_io->counter;
+			extend(async_ot, &prg, next_buf, next_buff, batch_size);
+			async_io->flush();
+			sent = async_io->counter - sent;
+			lock.lock();
+			async_sent += sent;
+			next_ready = true;
+			producer_cv.notify_all();
+		}
+	}
+
+	/* Fills buf/buff from the COT pool, or swaps in the batch prepared by the
+	 * producer, waiting for it if demand outran it. Returns false when neither
+	 * is in use and the caller has to extend in place. */
+	bool refill_prepared() {
+		++num_refill;
+		if(pool != nullptr) {
+			pool->next(buf, cur_party == BOB ? buff : nullptr, batch_size);
+			return true;
+		}
+		if(producer == nullptr)
+			return false;
+		std::unique_lock<std::mutex> lock(producer_mtx);
+		if(!next_ready) {
+			// the peer may be waiting on data we have not flushed yet
+			io->flush();
+			auto start = clock_start();
+			producer_cv.wait(lock, [this]() { return next_ready; });
+			refill_wait += time_from(start);
+			++num_refill_stall;
+		}
+		std::swap(buf, next_buf);
+		std::swap(buff, next_buff);
+		next_ready = false;
+		producer_cv.notify_all();
+		return true;
+	}
+
+	void stop_async_refill() {
+		if(producer == nullptr)
+			return;
+		{
+			std::lock_guard<std::mutex> lock(producer_mtx);
+			producer_stop = true;
+		}
+		producer_cv.notify_all();
+		producer->join();
+		delete producer;
+		producer = nullptr;
+		delete async_ot;
+		async_ot = nullptr;
+		delete[] next_buf;
+		delete[] next_buff;
+	}
 };
 }
 #endif
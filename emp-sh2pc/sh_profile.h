@@ -0,0 +1,209 @@
+#ifndef EMP_SH_PROFILE_H__
+#define EMP_SH_PROFILE_H__
+#include "emp-tool/emp-tool.h"
+#include "emp-sh2pc/sh_stats.h"
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace emp {
+
+// What a profiled region cost
+struct ProfileCost {
+	uint64_t num_and = 0;
+	uint64_t bytes_sent = 0;	// on all channels of the party
+	uint64_t num_cot = 0;
+	double time = 0;		// in us
+
+	// garbled tables of the region, two blocks per AND with half-gates
+	uint64_t garbled_bytes() const {
+		return num_and*2*sizeof(block);
+	}
+
+	ProfileCost & operator+=(const ProfileCost & c) {
+		num_and += c.num_and;
+		bytes_sent += c.bytes_sent;
+		num_cot += c.num_cot;
+		time += c.time;
+		return *this;
+	}
+
+	ProfileCost operator-(const ProfileCost & c) const {
+		ProfileCost res;
+		res.num_and = num_and - c.num_and;
+		res.bytes_sent = bytes_sent - c.bytes_sent;
+		res.num_cot = num_cot - c.num_cot;
+		res.time = time - c.time;
+		return res;
+	}
+
+	// Counters of the current party now; only num_and and time without a SemiHonestParty
+	static ProfileCost now() {
+		ProfileCost res;
+		PhaseCounter * party = dynamic_cast<PhaseCounter*>(ProtocolExecution::prot_exec);
+		if(party != nullptr) {
+			PartyStats s = party->stats();
+			res.num_and = s.num_and;
+			res.num_cot = s.num_cot;
+			for(int p = 0; p < NUM_PHASE; ++p)
+				res.bytes_sent += s.bytes_sent[p];
+		} else if(CircuitExecution::circ_exec != nullptr)
+			res.num_and = CircuitExecution::circ_exec->num_and();
+		res.time = std::chrono::duration<double, std::micro>(clock_start().time_since_epoch()).count();
+		return res;
+	}
+};
+
+enum ProfileMetric {
+	PROFILE_AND = 0,
+	PROFILE_GARBLED_BYTES,
+	PROFILE_BYTES_SENT,
+	PROFILE_COT,
+	PROFILE_TIME,
+};
+
+/* Tree of named regions of application code, each with the total cost of all
+ * its runs. Regions are opened by ProfileScope on the profiler current on the
+ * thread; a region nested in another one is a child of it, so every cost is
+ * also part of its ancestors'. The root spans from construction to stop(). */
+class Profiler { public:
+	struct Node {
+		std::string name;
+		int parent;
+		std::vector<int> children;
+		ProfileCost total;
+		uint64_t calls;
+	};
+
+	std::vector<Node> nodes;
+	int cur = 0;
+	ProfileCost start;
+	Profiler * prev = nullptr;
+	bool running = true;
+
+	// Profiles the calling thread until stop()
+	Profiler(const std::string & name = "all") {
+		nodes.push_back(Node{name, -1, {}, ProfileCost(), 1});
+		prev = current();
+		current() = this;
+		start = ProfileCost::now();
+	}
+
+	~Profiler() {
+		stop();
+	}
+
+	Profiler(const Profiler &) = delete;
+	Profiler & operator=(const Profiler &) = delete;
+
+	void stop() {
+		if(!running)
+			return;
+		nodes[0].total = ProfileCost::now() - start;
+		current() = prev;
+		running = false;
+	}
+
+	static Profiler *& current() {
+		static thread_local Profiler * profiler = nullptr;
+		return profiler;
+	}
+
+	// child of cur called name, created on first use
+	int enter(const char * name) {
+		for(int c : nodes[cur].children)
+			if(nodes[c].name == name)
+				return cur = c;
+		nodes.push_back(Node{name, cur, {}, ProfileCost(), 0});
+		nodes[cur].children.push_back(nodes.size() - 1);
+		return cur = nodes.size() - 1;
+	}
+
+	void leave(int node, const ProfileCost & cost) {
+		nodes[node].total += cost;
+		++nodes[node].calls;
+		cur = nodes[node].parent;
+	}
+
+	static double value(const ProfileCost & c, int metric) {
+		switch(metric) {
+		case PROFILE_AND: return c.num_and;
+		case PROFILE_GARBLED_BYTES: return c.garbled_bytes();
+		case PROFILE_BYTES_SENT: return c.bytes_sent;
+		case PROFILE_COT: return c.num_cot;
+		default: return c.time;
+		}
+	}
+
+	// cost of node outside its children
+	ProfileCost self(int node) const {
+		ProfileCost res = nodes[node].total;
+		for(int c : nodes[node].children)
+			res = res - nodes[c].total;
+		return res;
+	}
+
+	/* Folded stacks, one "root;child;grandchild self-value" line per region,
+	 * the input format of flamegraph.pl and speedscope. Call after stop(). */
+	std::string folded(int metric = PROFILE_AND) const {
+		std::ostringstream out;
+		for(size_t i = 0; i < nodes.size(); ++i) {
+			double v = value(self(i), metric);
+			if(v <= 0)
+				continue;
+			std::string path = nodes[i].name;
+			for(int p = nodes[i].parent; p >= 0; p = nodes[p].parent)
+				path = nodes[p].name + ";" + path;
+			out << path << " " << (uint64_t)v << "\n";
+		}
+		return out.str();
+	}
+
+	// Indented tree with totals, and ANDs as a share of the root's
+	std::string report() const {
+		std::ostringstream out;
+		report(out, 0, 0);
+		return out.str();
+	}
+
+	void report(std::ostringstream & out, int node, int depth) const {
+		const Node & n = nodes[node];
+		double root = std::max<double>(1, nodes[0].total.num_and);
+		char line[256];
+		snprintf(line, sizeof(line), "%*s%-*s %8llu calls %12llu AND %5.1f%% %12llu bytes %10llu COT %10.3f ms\n",
+			2*depth, "", std::max(1, 32 - 2*depth), n.name.c_str(), (unsigned long long)n.calls,
+			(unsigned long long)n.total.num_and, 100*n.total.num_and/root,
+			(unsigned long long)n.total.bytes_sent, (unsigned long long)n.total.num_cot, n.total.time/1000);
+		out << line;
+		for(int c : n.children)
+			report(out, c, depth + 1);
+	}
+};
+
+/* Charges everything between construction and destruction to the region
+ * name, nested in the innermost open ProfileScope. Does nothing when no
+ * Profiler is running on this thread. */
+class ProfileScope { public:
+	Profiler * profiler;
+	int node = 0;
+	ProfileCost start;
+
+	explicit ProfileScope(const char * name) : profiler(Profiler::current()) {
+		if(profiler == nullptr)
+			return;
+		node = profiler->enter(name);
+		start = ProfileCost::now();
+	}
+
+	~ProfileScope() {
+		if(profiler != nullptr)
+			profiler->leave(node, ProfileCost::now() - start);
+	}
+
+	ProfileScope(const ProfileScope &) = delete;
+	ProfileScope & operator=(const ProfileScope &) = delete;
+};
+
+}
+#endif
@@ -0,0 +1,120 @@
+#ifndef EMP_SH_SESSION_H__
+#define EMP_SH_SESSION_H__
+#include "emp-sh2pc/semihonest.h"
+#include "emp-sh2pc/label_arena.h"
+
+namespace emp {
+
+/* Installs a pair of executions on the current thread for the lifetime of the
+ * scope and restores the previous ones afterwards. With emp-tool built with
+ * THREADING, circ_exec and prot_exec are thread-local, so independent
+ * sessions can run concurrently, each job on whichever pool thread picks it
+ * up. Without THREADING only one session may be active at a time.
+ * Entering a session also makes its label arena current. */
+class ExecutionScope { public:
+	CircuitExecution * prev_circ;
+	ProtocolExecution * prev_prot;
+	LabelArena * prev_arena;
+
+	ExecutionScope(CircuitExecution * circ, ProtocolExecution * prot) {
+		prev_circ = CircuitExecution::circ_exec;
+		prev_prot = ProtocolExecution::prot_exec;
+		prev_arena = LabelArena::current();
+		CircuitExecution::circ_exec = circ;
+		ProtocolExecution::prot_exec = prot;
+	}
+
+	template<typename Session>
+	explicit ExecutionScope(Session & session) : ExecutionScope(session.circ, session.ctx) {
+		LabelArena::current() = &session.arena;
+	}
+
+	~ExecutionScope() {
+		CircuitExecution::circ_exec = prev_circ;
+		ProtocolExecution::prot_exec = prev_prot;
+		LabelArena::current() = prev_arena;
+	}
+
+	ExecutionScope(const ExecutionScope &) = delete;
+	ExecutionScope & operator=(const ExecutionScope &) = delete;
+};
+
+struct SessionStats {
+	uint64_t num_job = 0;
+	uint64_t bytes_sent = 0;	// on all channels of the session
+	int num_channel = 0;
+	size_t memory = 0;		// COT buffers and label arena held by the session, in bytes
+	uint64_t num_and = 0;
+};
+
+/* Long-lived semi-honest session: base OTs, delta and extended COTs survive
+ * across jobs, and reset() between jobs costs one message instead of a full
+ * setup_semi_honest()/finalize_semi_honest() round. io is not owned.
+ * Constructing a session leaves the current thread's executions untouched. */
+template<typename IO>
+class SemiHonestSession { public:
+	IO * io = nullptr;
+	int party;
+	SemiHonestParty<IO> * ctx = nullptr;
+	CircuitExecution * circ = nullptr;
+	LabelArena arena;	// ArenaBits of the current job
+	uint64_t num_job = 0;
+
+	SemiHonestSession(IO * io, int party, int batch_size = 1024*16, int ot_type = IKNP_OT) {
+		this->io = io;
+		this->party = party;
+		ExecutionScope scope(nullptr, nullptr);
+		ctx = setup_semi_honest(io, party, batch_size, ot_type);
+		circ = CircuitExecution::circ_exec;
+		io->flush();
+	}
+
+	/* Makes this session current and reseeds it for the next job; labels from
+	 * earlier jobs must not be used afterwards, so the arena is emptied in
+	 * bulk. Both parties call it at the same point. */
+	void reset() {
+		activate();
+		arena.reset();
+		ctx->reset();
+		++num_job;
+	}
+
+	void activate() {
+		CircuitExecution::circ_exec = circ;
+		ProtocolExecution::prot_exec = ctx;
+		LabelArena::current() = &arena;
+	}
+
+	SessionStats stats() const {
+		SessionStats s;
+		s.num_job = num_job;
+		s.bytes_sent = io->counter;
+		s.num_channel = 1;
+		s.memory = ctx->batch_size * (sizeof(block) + 2*sizeof(bool));
+		if(ctx->producer != nullptr) {
+			// the producer thread updates async_io->counter unlocked
+			std::lock_guard<std::mutex> lock(ctx->producer_mtx);
+			s.bytes_sent += ctx->async_setup_sent + ctx->async_sent;
+			s.num_channel += 1;
+			s.memory += ctx->batch_size * (sizeof(block) + sizeof(bool));
+		}
+		s.memory += arena.capacity();
+		s.num_and = circ->num_and();
+		return s;
+	}
+
+	~SemiHonestSession() {
+		io->flush();
+		if(CircuitExecution::circ_exec == circ) {
+			CircuitExecution::circ_exec = nullptr;
+			ProtocolExecution::prot_exec = nullptr;
+		}
+		if(LabelArena::current() == &arena)
+			LabelArena::current() = nullptr;
+		delete circ;
+		delete ctx;
+	}
+};
+
+}
+#endif
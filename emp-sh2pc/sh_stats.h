@@ -0,0 +1,79 @@
+#ifndef EMP_SH_STATS_H__
+#define EMP_SH_STATS_H__
+#include "emp-tool/emp-tool.h"
+#include <chrono>
+#include <sstream>
+#include <string>
+
+namespace emp {
+
+// What the traffic and time of a SemiHonestParty are attributed to
+enum Phase {
+	PHASE_BASE_OT = 0,	// base OTs and the other setup messages
+	PHASE_OT_EXTENSION,	// COT refills, on all channels
+	PHASE_FEED,		// input corrections
+	PHASE_GATES,		// garbled tables, and everything outside the other phases
+	PHASE_REVEAL,
+	NUM_PHASE,
+};
+
+struct PartyStats {
+	uint64_t bytes_sent[NUM_PHASE] = {};
+	uint64_t bytes_recv[NUM_PHASE] = {};	// the peer's bytes_sent, see exchange_stats()
+	double time[NUM_PHASE] = {};		// wall time, in us
+	uint64_t num_refill = 0;
+	uint64_t num_refill_stall = 0;
+	uint64_t num_and = 0;	// through circ_exec and the batched engines
+	uint64_t num_xor = 0;	// XOR gates through circ_exec
+	uint64_t num_cot = 0;	// COTs consumed by BOB's inputs
+
+	static const char * phase_name(int phase) {
+		static const char * names[NUM_PHASE] = {"base_ot", "ot_extension", "feed", "gates", "reveal"};
+		return names[phase];
+	}
+
+	std::string json() const {
+		std::ostringstream out;
+		out << "{\"phases\": {";
+		for(int p = 0; p < NUM_PHASE; ++p)
+			out << (p == 0 ? "" : ", ") << "\"" << phase_name(p) << "\": {\"bytes_sent\": " << bytes_sent[p]
+				<< ", \"bytes_recv\": " << bytes_recv[p] << ", \"time_us\": " << time[p] << "}";
+		out << "}, \"num_refill\": " << num_refill << ", \"num_refill_stall\": " << num_refill_stall
+			<< ", \"num_and\": " << num_and << ", \"num_xor\": " << num_xor << ", \"num_cot\": " << num_cot << "}";
+		return out.str();
+	}
+};
+
+/* Phase accounting of a party: on every phase change, the bytes sent on the
+ * main channel and the wall time since the previous change are charged to
+ * the phase that ends. Phases nest by switching back to the returned one. */
+class PhaseCounter { public:
+	PartyStats counted;
+	int phase = PHASE_BASE_OT;
+	uint64_t last_counter = 0;
+	std::chrono::time_point<std::chrono::high_resolution_clock> last_time = clock_start();
+
+	virtual ~PhaseCounter() {}
+
+	// counter: bytes sent on the main channel so far; returns the phase left
+	int switch_phase(int next, uint64_t counter) {
+		auto now = clock_start();
+		counted.bytes_sent[phase] += counter - last_counter;
+		counted.time[phase] += std::chrono::duration<double, std::micro>(now - last_time).count();
+		last_counter = counter;
+		last_time = now;
+		int prev = phase;
+		phase = next;
+		return prev;
+	}
+
+	// Stats so far, with bytes_recv left at zero
+	virtual PartyStats stats() = 0;
+
+	/* stats() with bytes_recv filled in from the peer, which calls it at the
+	 * same point; the exchange itself is not counted. */
+	virtual PartyStats exchange_stats() = 0;
+};
+
+}
+#endif
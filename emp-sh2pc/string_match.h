@@ -0,0 +1,337 @@
+#ifndef EMP_STRING_MATCH_H__
+#define EMP_STRING_MATCH_H__
+#include "emp-tool/emp-tool.h"
+#include "emp-sh2pc/sh_batch.h"
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace emp {
+
+/* A secret string as width labels per character, LSB first, fed with a
+ * single call to feed(). Substrings and windows are plain offsets into the
+ * labels, so every character is fed exactly once however often it is used.
+ *
+ * By default characters are bytes (width 8). With a public alphabet agreed by
+ * both parties, character c is encoded as its index in the alphabet and width
+ * shrinks to ceil(log2(|alphabet|+1)): every comparison gets cheaper by the
+ * same factor, e.g. 3 labels instead of 8 for "ACGT". Characters outside the
+ * alphabet all share the last code; they are only allowed in texts, so they
+ * never match a pattern character. */
+class SecretString { public:
+	std::vector<Bit> bits;
+	int length = 0;
+	int width = 8;
+	std::string alphabet;
+
+	SecretString() {}
+
+	/* Only the party holding str (or everyone, for PUBLIC) needs to pass it;
+	 * the other one passes the agreed length and an empty string. */
+	SecretString(int length, const std::string & str, int party, const std::string & alphabet = "") {
+		this->length = length;
+		this->alphabet = alphabet;
+		width = width_of(alphabet);
+		bool * b = new bool[width*length];
+		for(int i = 0; i < length; ++i) {
+			uint32_t c = encode(i < (int)str.size() ? str[i] : alphabet.empty() ? 0 : alphabet[0]);
+			for(int j = 0; j < width; ++j)
+				b[width*i + j] = (c >> j) & 1;
+		}
+		init(b, party);
+		delete[] b;
+	}
+
+	static int width_of(const std::string & alphabet) {
+		if(alphabet.empty())
+			return 8;
+		int w = 1;
+		while((1u << w) < alphabet.size() + 1)
+			++w;
+		return w;
+	}
+
+	uint32_t encode(char c) const {
+		if(alphabet.empty())
+			return (uint8_t)c;
+		size_t pos = alphabet.find(c);
+		return pos == std::string::npos ? alphabet.size() : pos;
+	}
+
+	void init(const bool * b, int party) {
+		bits.resize(width*length);
+		if(party == PUBLIC) {
+			for(int i = 0; i < width*length; ++i)
+				bits[i] = Bit(b[i], PUBLIC);
+		} else if(length > 0)
+			ProtocolExecution::prot_exec->feed((block *)bits.data(), party, b, width*length);
+	}
+
+	int size() const {
+		return length;
+	}
+
+	// labels of character i
+	const Bit * operator[](int i) const {
+		return bits.data() + width*i;
+	}
+
+	// Copies labels, so deferred inputs are completed first
+	Integer char_at(int i) const {
+		flush_inputs();
+		Integer res;
+		res.bits.assign(bits.begin() + width*i, bits.begin() + width*(i + 1));
+		return res;
+	}
+
+	SecretString substr(int pos, int len) const {
+		flush_inputs();
+		SecretString res;
+		res.length = len;
+		res.width = width;
+		res.alphabet = alphabet;
+		res.bits.assign(bits.begin() + width*pos, bits.begin() + width*(pos + len));
+		return res;
+	}
+};
+
+/* Balanced reduction: len-1 gates of op, ceil(log2(len)) deep. Empty input
+ * gives the public identity. */
+template<typename Op>
+inline Bit reduce_tree(std::vector<Bit> v, Op op, bool identity) {
+	if(v.empty())
+		return Bit(identity, PUBLIC);
+	while(v.size() > 1) {
+		size_t half = v.size()/2;
+		for(size_t i = 0; i < half; ++i)
+			v[i] = op(v[2*i], v[2*i+1]);
+		if(v.size() % 2 == 1) {
+			v[half] = v.back();
+			v.resize(half + 1);
+		} else v.resize(half);
+	}
+	return v[0];
+}
+
+inline Bit and_tree(const std::vector<Bit> & v) {
+	return reduce_tree(v, [](const Bit & a, const Bit & b) { return a & b; }, true);
+}
+
+inline Bit or_tree(const std::vector<Bit> & v) {
+	return reduce_tree(v, [](const Bit & a, const Bit & b) { return a | b; }, false);
+}
+
+// 1 iff text[pos, pos+pattern.size()) equals pattern: width*|pattern|-1 AND gates
+inline Bit window_equal(const SecretString & pattern, const SecretString & text, int pos) {
+	int w = pattern.width;
+	std::vector<Bit> eq(w*pattern.size());
+	for(int i = 0; i < w*pattern.size(); ++i)
+		eq[i] = !(pattern.bits[i] ^ text.bits[w*pos + i]);
+	return and_tree(eq);
+}
+
+// one match bit per window of text, in order of the window's offset
+inline std::vector<Bit> match_windows(const SecretString & pattern, const SecretString & text) {
+	std::vector<Bit> res;
+	for(int pos = 0; pos + pattern.size() <= text.size(); ++pos)
+		res.push_back(window_equal(pattern, text, pos));
+	return res;
+}
+
+// 1 iff pattern occurs anywhere in text
+inline Bit find_match(const SecretString & pattern, const SecretString & text) {
+	return or_tree(match_windows(pattern, text));
+}
+
+/* Number of set bits as an unsigned Integer, ceil(log2(len))+1 bits wide,
+ * summed by a balanced tree of adders. */
+inline Integer popcount(const std::vector<Bit> & v) {
+	if(v.empty())
+		return Integer(1, 0, PUBLIC);
+	std::vector<Integer> sum(v.size());
+	for(size_t i = 0; i < v.size(); ++i)
+		sum[i].bits.assign(1, v[i]);
+	while(sum.size() > 1) {
+		size_t half = sum.size()/2;
+		for(size_t i = 0; i < half; ++i) {
+			int width = std::max(sum[2*i].size(), sum[2*i+1].size()) + 1;
+			sum[i] = sum[2*i].resize(width, false) + sum[2*i+1].resize(width, false);
+		}
+		if(sum.size() % 2 == 1) {
+			sum[half] = sum.back();
+			sum.resize(half + 1);
+		} else sum.resize(half);
+	}
+	return sum[0];
+}
+
+// Bits of x in binary, floor(log2(x))+1, at least 1
+inline int bits_needed(uint64_t x) {
+	return x == 0 ? 1 : 64 - __builtin_clzll(x);
+}
+
+/* Secret wildcard mask for a pattern: bit i is set iff pattern[i] is
+ * wildcard. Fed by party in one call, like SecretString. */
+inline std::vector<Bit> wildcard_mask(int length, const std::string & pattern, char wildcard, int party) {
+	std::vector<Bit> res(length);
+	bool * b = new bool[length];
+	for(int i = 0; i < length; ++i)
+		b[i] = i < (int)pattern.size() and pattern[i] == wildcard;
+	if(length > 0)
+		ProtocolExecution::prot_exec->feed((block *)res.data(), party, b, length);
+	delete[] b;
+	return res;
+}
+
+struct MatchQuery {
+	int max_mismatch = 0;		// windows with up to this many differing characters match
+	std::vector<Bit> wildcard;	// from wildcard_mask(); empty for none
+	bool count = false;		// compute the number of matching windows
+	bool reveal_positions = false;	// BOB learns the offsets of the matching windows
+};
+
+struct MatchResult {
+	Bit found;
+	Integer count;			// with MatchQuery::count
+	std::vector<int64_t> positions;	// on BOB, with MatchQuery::reveal_positions
+};
+
+/* All outputs of query from one set of window bits, computed in one pass over
+ * the text labels. A window costs width*|p|-1 ANDs for exact matching, plus |p|
+ * with wildcards, plus a popcount and a compare for max_mismatch > 0. */
+inline MatchResult match(const SecretString & pattern, const SecretString & text, const MatchQuery & query = MatchQuery()) {
+	int m = pattern.size(), w = pattern.width;
+	std::vector<Bit> windows, chars(m), eq(w);
+	Integer bound;
+	if(query.max_mismatch > 0) {
+		// a popcount of m bits is at most m; one more bit for the signed compare
+		int width = std::max(bits_needed(m), bits_needed(query.max_mismatch)) + 1;
+		bound = Integer(width, query.max_mismatch, PUBLIC);
+	}
+	for(int pos = 0; pos + m <= text.size(); ++pos) {
+		for(int i = 0; i < m; ++i) {
+			for(int j = 0; j < w; ++j)
+				eq[j] = !(pattern.bits[w*i + j] ^ text.bits[w*(pos + i) + j]);
+			chars[i] = and_tree(eq);
+			if(!query.wildcard.empty())
+				chars[i] = chars[i] | query.wildcard[i];
+		}
+		if(query.max_mismatch == 0)
+			windows.push_back(and_tree(chars));
+		else {
+			for(int i = 0; i < m; ++i)
+				chars[i] = !chars[i];
+			windows.push_back(popcount(chars).resize(bound.size(), false) <= bound);
+		}
+	}
+
+	MatchResult res;
+	res.found = or_tree(windows);
+	// one more bit, so the count reveals as a nonnegative signed value
+	if(query.count)
+		res.count = popcount(windows).resize(bits_needed(windows.size()) + 1, false);
+	if(query.reveal_positions) {
+		std::vector<bool> open = reveal_batch(windows, BOB);
+		for(size_t i = 0; i < open.size(); ++i)
+			if(open[i] and ProtocolExecution::prot_exec->cur_party == BOB)
+				res.positions.push_back(i);
+	}
+	return res;
+}
+
+/* A dictionary of patterns fed by party in one call; lengths are public, the
+ * other party passes an empty patterns. */
+inline std::vector<SecretString> secret_dictionary(const std::vector<int> & lengths, const std::vector<std::string> & patterns, int party, const std::string & alphabet = "") {
+	std::string all;
+	for(size_t i = 0; i < lengths.size(); ++i) {
+		std::string p = i < patterns.size() ? patterns[i] : "";
+		p.resize(lengths[i], alphabet.empty() ? 0 : alphabet[0]);
+		all += p;
+	}
+	SecretString joint(all.size(), all, party, alphabet);
+	std::vector<SecretString> res;
+	int pos = 0;
+	for(int len : lengths) {
+		res.push_back(joint.substr(pos, len));
+		pos += len;
+	}
+	return res;
+}
+
+/* One match bit per pattern of the dictionary against a text fed once. Only
+ * the setup and the text feed are shared: the gates are those of one
+ * find_match() per pattern, so the cost grows linearly with the dictionary.
+ * Character equalities are not shared between patterns, since which pattern
+ * characters coincide is ALICE's secret, and selecting a precomputed
+ * (one-hot) text equality by a secret character costs |alphabet| ANDs, more
+ * than the width-1 of comparing directly. Encode both sides over a small
+ * alphabet to cut the cost of every pattern instead. */
+inline std::vector<Bit> match_dictionary(const std::vector<SecretString> & dictionary, const SecretString & text) {
+	std::vector<Bit> res;
+	for(const auto & pattern : dictionary)
+		res.push_back(find_match(pattern, text));
+	return res;
+}
+
+/* Matches a text that arrives in chunks of any size. Only the last
+ * |pattern|-1 characters are carried over from one chunk to the next and each
+ * chunk's result is folded into a running secret bit, so memory is bounded by
+ * the chunk size whatever the length of the text. */
+class StreamMatcher { public:
+	SecretString pattern;
+	SecretString tail;
+	int party;
+	Bit found;
+	bool any = false;	// found holds the result of a window
+	int64_t consumed = 0;
+
+	// party holds the text
+	StreamMatcher(const SecretString & pattern, int party) {
+		flush_inputs();
+		this->pattern = pattern;
+		this->party = party;
+		tail = pattern.substr(0, 0);
+	}
+
+	/* Both parties call it with the same length; only party passes data. */
+	void update(const char * data, int length) {
+		SecretString chunk(length, data == nullptr ? std::string() : std::string(data, length), party, pattern.alphabet);
+		// the chunk's labels are copied below, complete them where feed() put them
+		flush_inputs();
+		SecretString text = tail;
+		text.bits.insert(text.bits.end(), chunk.bits.begin(), chunk.bits.end());
+		text.length += length;
+		if(text.size() >= pattern.size()) {
+			Bit m = find_match(pattern, text);
+			found = any ? found | m : m;
+			any = true;
+		}
+		int keep = std::min(text.size(), std::max(pattern.size() - 1, 0));
+		tail = text.substr(text.size() - keep, keep);
+		consumed += length;
+	}
+
+	// public 0 while the text is shorter than the pattern
+	Bit result() const {
+		return any ? found : Bit(false, PUBLIC);
+	}
+};
+
+/* 1 iff pattern occurs in the text_length characters of the text, read from
+ * in by party chunk_size characters at a time; the other party passes
+ * nullptr. */
+inline Bit stream_find_match(const SecretString & pattern, std::istream * in, int64_t text_length, int party, int chunk_size = 1<<16) {
+	StreamMatcher matcher(pattern, party);
+	char * buf = new char[chunk_size];
+	for(int64_t i = 0; i < text_length; i += chunk_size) {
+		int n = (int)std::min<int64_t>(chunk_size, text_length - i);
+		if(in != nullptr and !in->read(buf, n))
+			error("text stream ended early\n");
+		matcher.update(in != nullptr ? buf : nullptr, n);
+	}
+	delete[] buf;
+	return matcher.result();
+}
+
+}
+#endif
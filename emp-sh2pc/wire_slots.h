@@ -0,0 +1,79 @@
+#ifndef EMP_WIRE_SLOTS_H__
+#define EMP_WIRE_SLOTS_H__
+#include "emp-sh2pc/circuit_trace.h"
+#include <vector>
+
+namespace emp {
+
+/* Label slots of a fixed arena: released slots are handed out again before
+ * the arena grows, so it ends up as large as the most wires ever live at
+ * once rather than the total wire count. */
+class SlotAllocator { public:
+	std::vector<uint32_t> free_slots;
+	uint32_t num_slot = 0;
+
+	SlotAllocator(uint32_t reserved = 0) : num_slot(reserved) {}
+
+	uint32_t get() {
+		if(free_slots.empty())
+			return num_slot++;
+		uint32_t s = free_slots.back();
+		free_slots.pop_back();
+		return s;
+	}
+
+	void put(uint32_t s) {
+		free_slots.push_back(s);
+	}
+};
+
+/* Renames the wires of ir to label slots by liveness: a wire's slot is
+ * released after the last gate reading it and reused by a later gate, so
+ * CircuitReplay needs num_wire = the circuit's maximum live width. Inputs and
+ * the constants keep their slots; outputs stay live to the end. The result is
+ * no longer in single-assignment form, so apply it after optimize_circuit. */
+inline TracedCircuit recycle_wires(const TracedCircuit & ir) {
+	const int64_t DEAD = -1;
+	int64_t G = ir.gates.size();
+	uint32_t first = 2 + ir.num_input;
+	std::vector<int64_t> last(ir.num_wire, DEAD);
+	for(int64_t i = 0; i < G; ++i) {
+		last[ir.gates[i].in0] = i;
+		last[ir.gates[i].in1] = i;
+	}
+	for(uint32_t w : ir.outputs)
+		last[w] = G;
+
+	SlotAllocator slots(first);
+	std::vector<uint32_t> slot(ir.num_wire);
+	for(uint32_t w = 0; w < first; ++w) {
+		slot[w] = w;
+		if(w >= 2 and last[w] == DEAD)
+			slots.put(w);
+	}
+
+	TracedCircuit res;
+	res.num_input = ir.num_input;
+	res.num_and = ir.num_and;
+	for(int64_t i = 0; i < G; ++i) {
+		TracedGate g = ir.gates[i];
+		g.in0 = slot[ir.gates[i].in0];
+		g.in1 = slot[ir.gates[i].in1];
+		// inputs are read before the output is written, so it may take their slot
+		if(ir.gates[i].in0 >= 2 and last[ir.gates[i].in0] == i)
+			slots.put(g.in0);
+		if(ir.gates[i].in1 >= 2 and last[ir.gates[i].in1] == i and ir.gates[i].in1 != ir.gates[i].in0)
+			slots.put(g.in1);
+		g.out = slot[ir.gates[i].out] = slots.get();
+		if(last[ir.gates[i].out] == DEAD)
+			slots.put(g.out);
+		res.gates.push_back(g);
+	}
+	for(uint32_t w : ir.outputs)
+		res.outputs.push_back(slot[w]);
+	res.num_wire = slots.num_slot;
+	return res;
+}
+
+}
+#endif
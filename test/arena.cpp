@@ -0,0 +1,55 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+const int N = 1000, W = 32;
+
+// Masked equality of every key against a probe, with Integer and with ArenaBits
+void test_arena(int party) {
+	vector<int64_t> keys(N);
+	for(int i = 0; i < N; ++i)
+		keys[i] = 7*i + 3;
+	int64_t probe = keys[N/2], mask = 0x0FFFFFFF;
+
+	auto start = clock_start();
+	Integer x(W, probe, ALICE), m(W, mask, PUBLIC);
+	vector<Bit> heap(N);
+	for(int i = 0; i < N; ++i) {
+		Integer k(W, keys[i], BOB);
+		heap[i] = ((k ^ x) & m) == Integer(W, 0, PUBLIC);
+	}
+	double t_heap = time_from(start);
+
+	LabelArena arena;
+	vector<Bit> bump(N);
+	start = clock_start();
+	{
+		ArenaScope scope(arena);
+		ArenaBits xa(W, probe, ALICE), ma(W, mask, PUBLIC), zero(W, 0, PUBLIC);
+		for(int i = 0; i < N; ++i) {
+			ArenaScope round(arena);
+			ArenaBits k(W, keys[i], BOB);
+			bump[i] = ((k ^ xa) & ma) == zero;
+		}
+	}
+	double t_arena = time_from(start);
+
+	vector<bool> a = reveal_batch(heap), b = reveal_batch(bump);
+	if(a != b)
+		error("arena result differs!");
+	for(int i = 0; i < N; ++i)
+		if(a[i] != (i == N/2))
+			error("equality error!");
+	cout << "Integer:\t" << t_heap << " us" << endl;
+	cout << "ArenaBits:\t" << t_arena << " us, arena " << arena.capacity() << " bytes" << endl;
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	setup_semi_honest(io, party);
+	test_arena(party);
+	finalize_semi_honest();
+	delete io;
+}
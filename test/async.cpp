@@ -0,0 +1,38 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+void test_async_feed(int party, int runs = 1000) {
+	PRG prg(fix_key);
+	vector<int> plain(runs);
+	vector<Integer> in;
+	for(int i = 0; i < runs; ++i) {
+		prg.random_data(&plain[i], 4);
+		in.push_back(Integer(32, plain[i], BOB));
+	}
+	vector<int> res = reveal_batch<int>(in, PUBLIC);
+	for(int i = 0; i < runs; ++i)
+		if(res[i] != plain[i])
+			error("async refill error!");
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	NetIO * ot_io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port+1);
+
+	auto ctx = setup_semi_honest(io, party);
+	ctx->set_batch_size(1024);
+	ctx->enable_async_refill(ot_io);
+
+	auto start = clock_start();
+	test_async_feed(party);
+	cout << "feed time: "<<time_from(start)<<" us"<<endl;
+	cout << "refills: "<<ctx->num_refill<<", stalled: "<<ctx->num_refill_stall
+		<<", waited: "<<ctx->refill_wait<<" us"<<endl;
+
+	finalize_semi_honest();
+	delete ot_io;
+	delete io;
+}
@@ -0,0 +1,32 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+void test_feed(int party) {
+	Integer a(32, 7, ALICE);
+	Integer b(32, 11, BOB);
+	if((a + b).reveal<int32_t>(PUBLIC) != 18)
+		error("base OT cache error!");
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	string file = "/tmp/emp_sh2pc_base_ot_" + to_string(party);
+	remove(file.c_str());
+	block key = makeBlock(0x1234, 0x5678);
+
+	// first start runs base OTs, later ones (simulated restarts) reuse them
+	for(int i = 0; i < 3; ++i) {
+		NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port+i, true);
+		BaseOTCache cache(file, party==ALICE ? "127.0.0.1" : "server", key);
+		bool cached = cache.valid;
+		auto start = clock_start();
+		setup_semi_honest(io, party, &cache);
+		cout << (cached ? "cached" : "fresh") << " setup: "<<time_from(start)<<" us, "<<io->counter<<" bytes"<<endl;
+		test_feed(party);
+		finalize_semi_honest();
+		delete io;
+	}
+	remove(file.c_str());
+}
@@ -0,0 +1,86 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+const string circuit_file_location = macro_xstr(EMP_CIRCUIT_PATH);
+
+int port, party;
+string file = circuit_file_location+"/bristol_format/AES-non-expanded.txt";
+BristolFormat cf(file.c_str());
+
+// AND gates per second of runs instances, one at a time or width at a time
+void test(NetIO * io, int runs, int width) {
+	int64_t ands_per_run = 0;
+	for(int i = 0; i < cf.num_gate; ++i)
+		if(cf.gates[4*i+3] == AND_GATE)
+			++ands_per_run;
+
+	vector<Integer> a, b;
+	for(int k = 0; k < width; ++k) {
+		a.push_back(Integer(128, 2 + k, ALICE));
+		b.push_back(Integer(128, 3 + k, BOB));
+	}
+	vector<block> in1(width*128), in2(width*128), out(width*128);
+	for(int k = 0; k < width; ++k) {
+		memcpy(in1.data() + 128*k, a[k].bits.data(), 128*sizeof(block));
+		memcpy(in2.data() + 128*k, b[k].bits.data(), 128*sizeof(block));
+	}
+
+	Integer c(128, 1, PUBLIC);
+	io->flush();
+	auto start = clock_start();
+	for(int i = 0; i < runs; ++i)
+		cf.compute((block*)c.bits.data(), in1.data() + 128*(i % width), in2.data() + 128*(i % width));
+	io->flush();
+	double single = time_from(start);
+
+	BristolBatch<NetIO> batch(&cf, io, width);
+	start = clock_start();
+	for(int i = 0; i < runs; i += width)
+		batch.compute(out.data(), in1.data(), in2.data());
+	io->flush();
+	double batched = time_from(start);
+
+	// every instance of the last batch against one more run of the single loop
+	vector<Integer> res(2*width, Integer(128, 0, PUBLIC));
+	for(int k = 0; k < width; ++k) {
+		memcpy(res[k].bits.data(), out.data() + 128*k, 128*sizeof(block));
+		cf.compute((block*)res[width + k].bits.data(), in1.data() + 128*k, in2.data() + 128*k);
+	}
+	for(int k = 0; k < width; ++k)
+		if(res[k].reveal<string>(PUBLIC) != res[width + k].reveal<string>(PUBLIC))
+			error("batched AES differs!");
+
+	cout << "one instance at a time:\t" << ands_per_run*runs/single*1e6 << " AND/s" << endl;
+	cout << width << " instances per gate:\t" << ands_per_run*runs/batched*1e6 << " AND/s" << endl;
+}
+
+// Two batches on one party: the gate ids of their compute() calls never overlap
+void test_gate_ids(NetIO * io) {
+	BristolBatch<NetIO> x(&cf, io, 2), y(&cf, io, 3);
+	vector<block> in(3*256), out(3*128);
+	for(auto & l : in)
+		l = CircuitExecution::circ_exec->public_label(false);
+	vector<pair<uint64_t, uint64_t>> used;
+	for(int i = 0; i < 4; ++i) {
+		BristolBatch<NetIO> & b = i % 2 == 0 ? x : y;
+		b.compute(out.data(), in.data(), in.data() + 3*128);
+		if(b.gid_end - b.gid_begin != b.ands_per_run*b.width or b.gid != b.gid_end)
+			error("batch gate ids do not cover its AND gates!");
+		for(const auto & r : used)
+			if(b.gid_begin < r.second and r.first < b.gid_end)
+				error("two batches reuse gate ids!");
+		used.push_back(make_pair(b.gid_begin, b.gid_end));
+	}
+}
+
+int main(int argc, char** argv) {
+	parse_party_and_port(argv, &party, &port);
+	NetIO* io = new NetIO(party==ALICE?nullptr:"127.0.0.1", port);
+
+	setup_semi_honest(io, party);
+	test(io, 10000, 8);
+	test_gate_ids(io);
+
+	finalize_semi_honest();
+	delete io;
+}
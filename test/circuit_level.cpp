@@ -0,0 +1,56 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+const string circuit_file_location = macro_xstr(EMP_CIRCUIT_PATH);
+
+const int threads = 4;
+
+// Parse vs map time, then the file-order loop against level-parallel garbling
+void test(int party, NetIO * io, const string & name, int runs) {
+	string file = circuit_file_location + "/bristol_format/" + name;
+	// both parties run from the same directory
+	string compiled = name + "." + to_string(party) + ".bin";
+
+	auto start = clock_start();
+	BristolFormat cf(file.c_str());
+	double parse = time_from(start);
+	CompiledCircuit::compile(&cf, compiled.c_str());
+	start = clock_start();
+	CompiledCircuit cc(compiled.c_str());
+	double load = time_from(start);
+
+	Integer a(cf.n1, 2, ALICE), b(cf.n2, 3, BOB);
+	Integer c(cf.n3, 0, PUBLIC), d(cf.n3, 0, PUBLIC);
+	io->flush();
+	start = clock_start();
+	for(int i = 0; i < runs; ++i)
+		cf.compute((block*)c.bits.data(), (block*)a.bits.data(), (block*)b.bits.data());
+	io->flush();
+	double file_order = time_from(start);
+
+	LevelParallelCircuit<NetIO> level(&cc, io, threads);
+	start = clock_start();
+	for(int i = 0; i < runs; ++i)
+		level.compute((block*)d.bits.data(), (block*)a.bits.data(), (block*)b.bits.data());
+	io->flush();
+	double parallel = time_from(start);
+
+	if(c.reveal<string>(PUBLIC) != d.reveal<string>(PUBLIC))
+		error("level-parallel output differs!");
+	cout << name << ": " << cc.header->num_gate << " gates, " << cc.header->num_and << " ANDs in "
+		<< cc.header->num_level << " levels" << endl;
+	cout << "\t" << cc.header->num_wire << " wires in " << cc.header->num_slot << " label slots" << endl;
+	cout << "\tparse " << parse << " us, map " << load << " us" << endl;
+	cout << "\tfile order " << file_order << " us, " << threads << " threads by level " << parallel << " us" << endl;
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	setup_semi_honest(io, party);
+	test(party, io, "AES-non-expanded.txt", 1000);
+	test(party, io, "sha-256.txt", 100);
+	finalize_semi_honest();
+	delete io;
+}
@@ -0,0 +1,37 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	string file = "/tmp/emp_sh2pc_cot_pool_" + to_string(party);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+
+	// offline
+	auto start = clock_start();
+	precompute_cot_pool(io, party, file.c_str(), 1<<20);
+	cout << "offline: "<<time_from(start)<<" us, "<<io->counter<<" bytes"<<endl;
+
+	// online, twice to check the pool resumes where the last session stopped
+	for(int j = 0; j < 2; ++j) {
+		uint64_t counter = io->counter;
+		start = clock_start();
+		setup_semi_honest(io, party, file.c_str());
+		PRG prg(fix_key);
+		vector<int> plain(1000);
+		vector<Integer> in;
+		for(int i = 0; i < 1000; ++i) {
+			prg.random_data(&plain[i], 4);
+			in.push_back(Integer(32, plain[i], BOB));
+		}
+		vector<int> res = reveal_batch<int>(in, PUBLIC);
+		for(int i = 0; i < 1000; ++i)
+			if(res[i] != plain[i])
+				error("cot pool error!");
+		cout << "online: "<<time_from(start)<<" us, "<<io->counter - counter<<" bytes"<<endl;
+		finalize_semi_honest();
+	}
+	delete io;
+	remove(file.c_str());
+}
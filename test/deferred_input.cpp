@@ -0,0 +1,71 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+const int N = 1000;
+
+/* Sum of N values fed by BOB and which of them equal ALICE's key, with the
+ * corrections of all values sent together or flushed after every value. */
+void test_inputs(int party, bool per_value) {
+	vector<int32_t> v(N);
+	for(int i = 0; i < N; ++i)
+		v[i] = (i*37) % 101;
+	int32_t key = 42;
+
+	auto start = clock_start();
+	vector<Integer> x;
+	x.reserve(N);	// labels are completed in place, so they must not move
+	for(int i = 0; i < N; ++i) {
+		x.emplace_back(32, v[i], BOB);
+		if(per_value)
+			flush_inputs();
+	}
+	Integer k(32, key, ALICE), sum(32, 0, PUBLIC);
+	vector<Bit> eq;
+	for(int i = 0; i < N; ++i) {
+		sum = sum + x[i];
+		eq.push_back(x[i] == k);
+	}
+	int32_t s = sum.reveal<int32_t>(PUBLIC);
+	vector<bool> match = reveal_batch(eq);
+	double t = time_from(start);
+
+	int32_t expected = 0;
+	for(int i = 0; i < N; ++i) {
+		expected += v[i];
+		if(match[i] != (v[i] == key))
+			error("deferred equality error!");
+	}
+	if(s != expected)
+		error("deferred sum error!");
+	cout << (per_value ? "flush per value:\t" : "one flush:\t") << t << " us" << endl;
+}
+
+// Two feed_batch calls whose corrections go out together at the first gate
+void test_batches(int party) {
+	vector<int32_t> a = {3, -7, 11, 0}, b = {100, 200, -300, 5};
+	vector<Integer> x = feed_batch(party == BOB ? a.data() : nullptr, a.size(), 32, BOB);
+	vector<Integer> y = feed_batch(party == BOB ? b.data() : nullptr, b.size(), 32, BOB);
+	DeferredInputs * d = dynamic_cast<DeferredInputs*>(ProtocolExecution::prot_exec);
+	if(d->num_pending != 32*(int64_t)(a.size() + b.size()))
+		error("feed_batch did not defer its inputs!");
+	vector<Integer> sum;
+	for(size_t i = 0; i < a.size(); ++i)
+		sum.push_back(x[i] + y[i]);
+	vector<int64_t> r = reveal_batch<int64_t>(sum);
+	for(size_t i = 0; i < a.size(); ++i)
+		if(r[i] != a[i] + b[i])
+			error("deferred feed_batch error!");
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	setup_semi_honest(io, party, 1024*16, IKNP_OT, true);
+	test_inputs(party, true);
+	test_inputs(party, false);
+	test_batches(party);
+	finalize_semi_honest();
+	delete io;
+}
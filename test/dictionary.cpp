@@ -0,0 +1,53 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+const string dna = "ACGT";
+
+string random_dna(PRG & prg, int len) {
+	string s(len, 'A');
+	uint8_t * r = new uint8_t[len];
+	prg.random_data(r, len);
+	for(int i = 0; i < len; ++i)
+		s[i] = dna[r[i] % 4];
+	delete[] r;
+	return s;
+}
+
+// Both parties derive the same text and dictionary, so results can be checked
+void test_dictionary(int party, int text_len, int num_pattern, const string & alphabet) {
+	PRG prg(fix_key);
+	string text = random_dna(prg, text_len);
+	vector<string> patterns;
+	vector<int> lengths;
+	for(int i = 0; i < num_pattern; ++i) {
+		int len = 4 + i % 5;
+		if(i % 2 == 0)
+			patterns.push_back(text.substr((i * 37) % (text_len - len), len));
+		else patterns.push_back(random_dna(prg, len));
+		lengths.push_back(len);
+	}
+
+	uint64_t num_and = CircuitExecution::circ_exec->num_and();
+	vector<SecretString> dictionary = secret_dictionary(lengths, party == ALICE ? patterns : vector<string>(), ALICE, alphabet);
+	SecretString text_labels(text_len, party == BOB ? text : "", BOB, alphabet);
+	vector<bool> res = reveal_batch(match_dictionary(dictionary, text_labels));
+	num_and = CircuitExecution::circ_exec->num_and() - num_and;
+
+	for(int i = 0; i < num_pattern; ++i)
+		if(res[i] != (text.find(patterns[i]) != string::npos))
+			error("dictionary match error!");
+	cout << num_pattern << " patterns, " << text_len << " characters, "
+		<< (alphabet.empty() ? "8-bit" : alphabet) << " encoding: " << num_and << " ANDs" << endl;
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	setup_semi_honest(io, party);
+	test_dictionary(party, 1000, 64, "");
+	test_dictionary(party, 1000, 64, dna);
+	finalize_semi_honest();
+	delete io;
+}
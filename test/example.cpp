@@ -12,31 +12,25 @@ void test_millionare(int party, int number) {
 
 void test_sort(int party) {
 	int size = 100;
-	Integer *A = new Integer[size];
-	Integer *B = new Integer[size];
-	Integer *res = new Integer[size];
-
-// First specify Alice's input
+	vector<int32_t> a(size), b(size);
 	for(int i = 0; i < size; ++i)
-		A[i] = Integer(32, rand()%102400, ALICE);
-
-
-// Now specify Bob's input
+		a[i] = rand()%102400;
 	for(int i = 0; i < size; ++i)
-		B[i] = Integer(32, rand()%102400, BOB);
+		b[i] = rand()%102400;
+
+// Each party's array goes in with one feed
+	vector<Integer> A = feed_batch(a.data(), size, 32, ALICE);
+	vector<Integer> B = feed_batch(b.data(), size, 32, BOB);
+	vector<Integer> res(size);
 
 //Now compute
 	for(int i = 0; i < size; ++i)
 		res[i] = A[i] ^ B[i];
 	
 
-	sort(res, size);
+	sort(res.data(), size);
 	for(int i = 0; i < 100; ++i)
 		cout << res[i].reveal<int32_t>()<<endl;
-
-	delete[] A;
-	delete[] B;
-	delete[] res;
 }
 
 int main(int argc, char** argv) {
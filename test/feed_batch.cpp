@@ -0,0 +1,67 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+const int N = 10000;
+
+// N values of BOB through one Integer constructor each and through feed_batch
+void test_integers(int party) {
+	vector<int32_t> v(N);
+	for(int i = 0; i < N; ++i)
+		v[i] = i*7919 - N*1000;
+
+	auto start = clock_start();
+	vector<Integer> one;
+	for(int i = 0; i < N; ++i)
+		one.push_back(Integer(32, v[i], BOB));
+	double t_one = time_from(start);
+
+	start = clock_start();
+	vector<Integer> batch = feed_batch(party == BOB ? v.data() : nullptr, N, 32, BOB);
+	double t_batch = time_from(start);
+
+	vector<int64_t> a = reveal_batch<int64_t>(one), b = reveal_batch<int64_t>(batch);
+	for(int i = 0; i < N; ++i)
+		if(a[i] != v[i] or b[i] != v[i])
+			error("feed_batch error!");
+	cout << "Integer per value:\t" << t_one << " us" << endl;
+	cout << "feed_batch:\t" << t_batch << " us" << endl;
+}
+
+// Widths other than the type's, sign extended or truncated as by Integer
+void test_widths(int party) {
+	vector<int64_t> v = {0, 1, -1, 5, -6, 1LL << 40, -(1LL << 40), 123456789};
+	for(int width : {3, 8, 20, 48, 64, 80}) {
+		vector<Integer> x = feed_batch(party == ALICE ? v.data() : nullptr, v.size(), width, ALICE);
+		vector<int64_t> r = reveal_batch<int64_t>(x);
+		for(size_t i = 0; i < v.size(); ++i) {
+			int64_t expected = width >= 64 ? v[i] : (int64_t)((uint64_t)v[i] << (64 - width)) >> (64 - width);
+			if(r[i] != expected)
+				error("feed_batch width error!");
+		}
+	}
+}
+
+void test_floats(int party) {
+	vector<float> v = {0.0f, 1.5f, -2.25f, 3.14159f, 1e-20f, -1e20f};
+	vector<Float> x = feed_batch(party == BOB ? v.data() : nullptr, v.size(), BOB);
+	for(size_t i = 0; i < v.size(); ++i) {
+		uint32_t bits;
+		memcpy(&bits, &v[i], 4);
+		for(int j = 0; j < 32; ++j)
+			if(x[i][j].reveal<bool>() != (bool)((bits >> j) & 1))
+				error("feed_batch float error!");
+	}
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	setup_semi_honest(io, party);
+	test_integers(party);
+	test_widths(party);
+	test_floats(party);
+	finalize_semi_honest();
+	delete io;
+}
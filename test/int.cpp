@@ -32,6 +32,25 @@ void test_int(int party, int range1 = 1<<20, int range2 = 1<<20, int runs = 1000
 	cout << typeid(Op2).name()<<"\t\t\tDONE"<<endl;
 }
 
+void test_reveal_batch(int party, int runs = 1000) {
+	PRG prg(fix_key);
+	vector<int> plain(runs);
+	vector<Integer> in;
+	for(int i = 0; i < runs; ++i) {
+		prg.random_data(&plain[i], 4);
+		in.push_back(Integer(32, plain[i], i%2 ? ALICE : BOB));
+	}
+	for(int p : {PUBLIC, ALICE, BOB}) {
+		vector<int> res = reveal_batch<int>(in, p);
+		if(p != PUBLIC and p != party)
+			continue;
+		for(int i = 0; i < runs; ++i)
+			if(res[i] != plain[i])
+				error("reveal_batch error!");
+	}
+	cout << "reveal_batch\t\t\tDONE"<<endl;
+}
+
 void scratch_pad() {
 	Integer a(32, 9, ALICE);
 	cout << "HW "<<a.hamming_weight().reveal<string>(PUBLIC)<<endl;
@@ -55,6 +74,8 @@ int main(int argc, char** argv) {
 	test_int<std::bit_or<int>, std::bit_or<Integer>>(party);
 	test_int<std::bit_xor<int>, std::bit_xor<Integer>>(party);
 
+	test_reveal_batch(party);
+
 	finalize_semi_honest();
 	delete io;
 }
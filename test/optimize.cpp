@@ -0,0 +1,80 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+const int P = 3, T = 16;
+
+// Window scan seeded with PUBLIC bits as in test/pattern_matching, and x*5+1
+vector<Bit> kernel(const vector<Bit> & in) {
+	vector<Integer> pattern(P), text(T);
+	for(int i = 0; i < P; ++i)
+		pattern[i].bits.assign(in.begin() + 8*i, in.begin() + 8*(i+1));
+	for(int i = 0; i < T; ++i)
+		text[i].bits.assign(in.begin() + 8*(P+i), in.begin() + 8*(P+i+1));
+	Bit any(false, PUBLIC);
+	for(int w = 0; w + P <= T; ++w) {
+		Bit all(true, PUBLIC);
+		for(int i = 0; i < P; ++i)
+			all = all & (pattern[i] == text[w+i]);
+		any = any | all;
+	}
+	Integer x;
+	x.bits.assign(in.begin() + 8*(P+T), in.end());
+	Integer y = x * Integer(32, 5, PUBLIC) + Integer(32, 1, PUBLIC);
+	vector<Bit> out = y.bits;
+	out.push_back(any);
+	return out;
+}
+
+uint64_t replay_ands(const TracedCircuit & ir, const vector<Bit> & in, vector<Bit> & out) {
+	CircuitReplay<NetIO> replay(&ir);
+	out.resize(ir.outputs.size());
+	uint64_t num_and = CircuitExecution::circ_exec->num_and();
+	replay.compute((block *)out.data(), (const block *)in.data());
+	return CircuitExecution::circ_exec->num_and() - num_and;
+}
+
+void test_optimize(int party) {
+	TracedCircuit ir = trace_circuit(8*(P+T) + 32, kernel);
+	TracedCircuit opt = optimize_circuit(ir);
+
+	string pattern = "GAT", text = "CATGATTACAGATTAC";
+	int32_t x = 123456;
+	vector<Bit> in;
+	for(int i = 0; i < P; ++i) {
+		Integer c(8, pattern[i], ALICE);
+		in.insert(in.end(), c.bits.begin(), c.bits.end());
+	}
+	for(int i = 0; i < T; ++i) {
+		Integer c(8, text[i], BOB);
+		in.insert(in.end(), c.bits.begin(), c.bits.end());
+	}
+	Integer xi(32, x, BOB);
+	in.insert(in.end(), xi.bits.begin(), xi.bits.end());
+
+	vector<Bit> out, out_opt;
+	uint64_t before = replay_ands(ir, in, out);
+	uint64_t after = replay_ands(opt, in, out_opt);
+
+	vector<bool> a = reveal_batch(out), b = reveal_batch(out_opt);
+	if(a != b)
+		error("optimized circuit differs!");
+	uint32_t y = (uint32_t)x*5 + 1;
+	for(int j = 0; j < 32; ++j)
+		if(b[j] != (bool)((y >> j) & 1))
+			error("optimized arithmetic error!");
+	if(!b[32])
+		error("optimized match error!");
+	cout << "gates:\t" << ir.gates.size() << " -> " << opt.gates.size() << endl;
+	cout << "ANDs:\t" << before << " -> " << after << endl;
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	setup_semi_honest(io, party);
+	test_optimize(party);
+	finalize_semi_honest();
+	delete io;
+}
@@ -0,0 +1,53 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+const char * ot_name[] = {"IKNP", "Ferret"};
+
+// Feeds num BOB bits in chunks and reports cost per fed bit for this party
+void bench_feed(NetIO * io, int party, int ot_type, int64_t num, int chunk = 1024) {
+	uint64_t counter = io->counter;
+	auto start = clock_start();
+	setup_semi_honest(io, party, 1024*16, ot_type);
+	double setup_time = time_from(start);
+	uint64_t setup_bytes = io->counter - counter;
+
+	block * label = new block[chunk];
+	bool * b = new bool[chunk];
+	PRG prg(fix_key);
+	counter = io->counter;
+	start = clock_start();
+	for(int64_t i = 0; i < num; i += chunk) {
+		prg.random_bool(b, chunk);
+		ProtocolExecution::prot_exec->feed(label, BOB, b, chunk);
+	}
+	io->flush();
+	double t = time_from(start);
+	uint64_t bytes = io->counter - counter;
+
+	// sanity check the last chunk
+	bool * res = new bool[chunk];
+	ProtocolExecution::prot_exec->reveal(res, PUBLIC, label, chunk);
+	for(int i = 0; i < chunk; ++i)
+		if(res[i] != b[i])
+			error("feed error!");
+
+	cout << ot_name[ot_type] << "\tsetup: "<<setup_time<<" us, "<<setup_bytes<<" bytes"
+		<<"\tfeed: "<<t*1000.0/num<<" ns/bit, "<<(double)bytes/num<<" bytes/bit"<<endl;
+	delete[] label;
+	delete[] b;
+	delete[] res;
+	finalize_semi_honest();
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	int64_t num = 1<<20;
+	if(argc > 3)
+		num = atoll(argv[3]);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	bench_feed(io, party, IKNP_OT, num);
+	bench_feed(io, party, FERRET_OT, num);
+	delete io;
+}
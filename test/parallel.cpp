@@ -0,0 +1,59 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+const int threads = 4;
+
+// every window of text compared against pattern, as in pattern_matching
+void test_parallel_match(int party, ParallelSemiHonest<NetIO> & par, int text_size = 2048, int pattern_size = 8) {
+	PRG prg(fix_key);
+	vector<uint8_t> text(text_size);
+	prg.random_data(text.data(), text_size);
+	vector<uint8_t> pattern(text.begin() + 1000, text.begin() + 1000 + pattern_size);
+
+	vector<Integer> p, t;
+	for(int i = 0; i < pattern_size; ++i)
+		p.push_back(Integer(8, pattern[i], ALICE));
+	for(int i = 0; i < text_size; ++i)
+		t.push_back(Integer(8, text[i], BOB));
+
+	int num_windows = text_size - pattern_size + 1;
+	vector<Bit> window_match(num_windows);
+	auto start = clock_start();
+	par.parallel_for(num_windows, [&](int64_t w) {
+		Bit all(true, PUBLIC);
+		for(int j = 0; j < pattern_size; ++j)
+			all = all & (p[j] == t[w + j]);
+		window_match[w] = all;
+	});
+	cout << "parallel windows: "<<time_from(start)<<" us, "<<par.num_and()<<" AND gates"<<endl;
+
+	Bit any(false, PUBLIC);
+	for(auto & b : window_match)
+		any = any | b;
+	if(!any.reveal<bool>(PUBLIC))
+		error("parallel match error!");
+	vector<bool> res = reveal_batch(window_match, PUBLIC);
+	for(int w = 0; w < num_windows; ++w)
+		if(res[w] != equal(pattern.begin(), pattern.end(), text.begin() + w))
+			error("parallel match error!");
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	NetIO * ios[threads];
+	for(int i = 0; i < threads; ++i)
+		ios[i] = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port+1+i, true);
+
+	setup_semi_honest(io, party);
+	{
+		ParallelSemiHonest<NetIO> par(party, ios, threads);
+		test_parallel_match(party, par);
+	}
+	finalize_semi_honest();
+	for(int i = 0; i < threads; ++i)
+		delete ios[i];
+	delete io;
+}
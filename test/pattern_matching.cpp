@@ -1,5 +1,7 @@
 #include "emp-sh2pc/emp-sh2pc.h"
 #include <getopt.h>
+#include <fstream>
+#include <sstream>
 using namespace emp;
 using namespace std;
 
@@ -162,8 +164,19 @@ namespace CommandLineArgumentProcessing {
       int port = -1;
       string pattern = "";
       string text = "";
+      string text_file = "";
       int pattern_length = -1;
-      int text_length = -1;
+      int64_t text_length = -1;
+      int chunk_size = 1 << 16;
+      int mismatches = 0;
+      bool wildcards = false;
+      bool count = false;
+      bool positions = false;
+      bool naive = false;
+      bool regex = false;
+      int states = -1;
+      string alphabet = "";
+      bool defer_inputs = false;
       bool help = false;
     };
 
@@ -175,8 +188,21 @@ namespace CommandLineArgumentProcessing {
             << "  --port <number>       Port number for network communication\n"
             << "  --pattern <string>    Secret pattern (for ALICE only)\n"
             << "  --text <string>       Secret text (for BOB only)\n"
+            << "  --text-file <path>    Read the secret text from a file (for BOB only)\n"
+            << "  --chunk-size <n>      Stream texts longer than n characters in chunks of n\n"
+            << "                        (both parties, default 65536)\n"
             << "  --pattern-length <n>  Pattern length (for BOB to know Alice's pattern size)\n"
             << "  --text-length <n>     Text length (for Alice to know Bob's text size)\n"
+            << "  --mismatches <k>      Also match windows with up to k differing characters\n"
+            << "  --wildcards           '?' in the pattern matches any character\n"
+            << "  --count               Output the number of matching windows\n"
+            << "  --positions           Reveal the matching offsets to BOB only\n"
+            << "                        (the four options above: both parties, no streaming)\n"
+            << "  --naive               Feed every window as 32-bit Integers (baseline)\n"
+            << "  --regex               The pattern is a regular expression, run as a secret DFA\n"
+            << "  --states <n>          DFA states agreed by both parties (with --regex)\n"
+            << "  --alphabet <chars>    Public alphabet of the text (with --regex, default all bytes)\n"
+            << "  --defer-inputs        Send BOB's input corrections in one message (both parties)\n"
             << "  --help                Show this help message\n\n"
             << "Examples:\n"
             << "  # Alice (pattern holder):\n"
@@ -197,6 +223,17 @@ namespace CommandLineArgumentProcessing {
       {"text", required_argument, 0, 't'},
       {"pattern-length", required_argument, 0, 'P'},
       {"text-length", required_argument, 0, 'T'},
+      {"text-file", required_argument, 0, 'f'},
+      {"chunk-size", required_argument, 0, 'c'},
+      {"mismatches", required_argument, 0, 'k'},
+      {"wildcards", no_argument, 0, 'w'},
+      {"count", no_argument, 0, 'C'},
+      {"positions", no_argument, 0, 'R'},
+      {"naive", no_argument, 0, 'n'},
+      {"regex", no_argument, 0, 'r'},
+      {"states", required_argument, 0, 'S'},
+      {"alphabet", required_argument, 0, 'a'},
+      {"defer-inputs", no_argument, 0, 'D'},
       {"help", no_argument, 0, 'h'},
       {0, 0, 0, 0}
     };
@@ -204,7 +241,7 @@ namespace CommandLineArgumentProcessing {
     int option_index = 0;
     int c;
   
-    while ((c = getopt_long(argc, argv, "i:o:p:t:P:T:h", long_options, &option_index)) != -1) {
+    while ((c = getopt_long(argc, argv, "i:o:p:t:P:T:f:c:k:wCRnrS:a:Dh", long_options, &option_index)) != -1) {
       switch (c) {
         case 'i':
           args.party_id = atoi(optarg);
@@ -234,12 +271,57 @@ namespace CommandLineArgumentProcessing {
           }
           break;
           case 'T':
-            args.text_length = atoi(optarg);
+            args.text_length = atoll(optarg);
             if (args.text_length <= 0) {
               cerr << "Error: text-length must be larger than 1" << endl;
               exit(1);
             }
             break;
+        case 'f':
+          args.text_file = string(optarg);
+          break;
+        case 'c':
+          args.chunk_size = atoi(optarg);
+          if (args.chunk_size <= 0) {
+            cerr << "Error: chunk-size must be at least ONE character" << endl;
+            exit(1);
+          }
+          break;
+        case 'k':
+          args.mismatches = atoi(optarg);
+          if (args.mismatches < 0) {
+            cerr << "Error: mismatches must not be negative" << endl;
+            exit(1);
+          }
+          break;
+        case 'w':
+          args.wildcards = true;
+          break;
+        case 'C':
+          args.count = true;
+          break;
+        case 'R':
+          args.positions = true;
+          break;
+        case 'n':
+          args.naive = true;
+          break;
+        case 'r':
+          args.regex = true;
+          break;
+        case 'S':
+          args.states = atoi(optarg);
+          if (args.states <= 0) {
+            cerr << "Error: states must be at least ONE" << endl;
+            exit(1);
+          }
+          break;
+        case 'a':
+          args.alphabet = string(optarg);
+          break;
+        case 'D':
+          args.defer_inputs = true;
+          break;
         case 'h':
           args.help = true;
           break;
@@ -270,6 +352,11 @@ namespace CommandLineArgumentProcessing {
       cerr << "Error: --port is required" << endl;
       exit(1);
     }
+
+    if (args.regex && args.states < 1) {
+      cerr << "Error: --regex needs --states on both parties" << endl;
+      exit(1);
+    }
     
     if (args.party_id == ALICE) {
       if (args.pattern.empty()) {
@@ -285,11 +372,11 @@ namespace CommandLineArgumentProcessing {
       }
 
     } else if (args.party_id == BOB) {
-        if (args.text.empty()) {
-            cerr << "Error: BOB (party 2) must provide --text" << endl;
+        if (args.text.empty() && args.text_file.empty()) {
+            cerr << "Error: BOB (party 2) must provide --text or --text-file" << endl;
             exit(1);
         }
-        if (args.pattern_length < 1) {
+        if (args.pattern_length < 1 && !args.regex) {
             cerr << "Error: BOB (party 2) must provide --pattern-length / --pattern-length must be at least ONE character" << endl;
             exit(1);
         }
@@ -326,7 +413,7 @@ Bit find_match(std::vector<Integer> pattern_vector, std::vector<std::vector<Inte
 }
 
 
-void test_matching(int party, string pattern, size_t pattern_size, string text, size_t text_size) {
+void test_matching_naive(int party, string pattern, size_t pattern_size, string text, size_t text_size) {
 
   size_t num_windows = text_size - pattern_size + 1;
 
@@ -348,19 +435,84 @@ void test_matching(int party, string pattern, size_t pattern_size, string text,
     pattern_vector.push_back(Integer(32, pattern_holder_ascii[i], ALICE));
   }
 
+  // Built in place: with --defer-inputs the labels are completed where they
+  // were fed, at the flush before find_match copies them
+  text_vector.reserve(num_windows);
   for(size_t i = 0; i < num_windows; i++) {
-    std::vector<Integer> temp_vec;
+    text_vector.emplace_back();
+    text_vector.back().reserve(pattern_size);
     for (size_t j = 0; j < pattern_size; j++) {
-      temp_vec.push_back(Integer(32, text_holder_ascii[i][j], BOB));
+      text_vector.back().emplace_back(32, text_holder_ascii[i][j], BOB);
     }
-    text_vector.push_back(temp_vec);
   }
+  flush_inputs();
 
   Bit res = find_match(pattern_vector, text_vector);
   cout << "Match found?\t" << res.reveal<bool>() << endl;
 }
 
 
+// Text fed once as 8-bit labels, windows are views into it (emp-sh2pc/string_match.h)
+void test_matching(int party, string pattern, size_t pattern_size, string text, size_t text_size,
+                   const CommandLineArgumentProcessing::ProgramArgs& args) {
+
+  SecretString pattern_labels(pattern_size, pattern, ALICE);
+  SecretString text_labels(text_size, text, BOB);
+
+  MatchQuery query;
+  query.max_mismatch = args.mismatches;
+  if (args.wildcards)
+    query.wildcard = wildcard_mask(pattern_size, pattern, '?', ALICE);
+  query.count = args.count;
+  query.reveal_positions = args.positions;
+
+  MatchResult res = match(pattern_labels, text_labels, query);
+  cout << "Match found?\t" << res.found.reveal<bool>() << endl;
+  if (args.count)
+    cout << "Match count:\t" << res.count.reveal<int64_t>() << endl;
+  if (args.positions && party == BOB) {
+    cout << "Match positions:";
+    for (int64_t pos : res.positions)
+      cout << " " << pos;
+    cout << endl;
+  }
+}
+
+
+// Pattern compiled into a secret DFA run over one-hot characters (emp-sh2pc/regex_match.h)
+void test_matching_regex(int party, string pattern, string text, size_t text_size, int states, const string& alphabet) {
+
+  SecretDfa dfa(states, pattern, ALICE, alphabet);
+  OneHotString text_labels(text_size, text, BOB, alphabet);
+
+  Bit res = dfa_find_match(dfa, text_labels);
+  cout << "Match found?\t" << res.reveal<bool>() << endl;
+}
+
+
+// Text streamed in chunks, only one chunk of labels alive at a time.
+void test_matching_stream(int party, string pattern, size_t pattern_size, string text, string text_file, int64_t text_size, int chunk_size) {
+
+  SecretString pattern_labels(pattern_size, pattern, ALICE);
+
+  ifstream file;
+  istringstream str(text);
+  istream * in = nullptr;
+  if (party == BOB && !text_file.empty()) {
+    file.open(text_file, ios::binary);
+    if (!file) {
+      cerr << "Error: cannot open " << text_file << endl;
+      exit(1);
+    }
+    in = &file;
+  } else if (party == BOB)
+    in = &str;
+
+  Bit res = stream_find_match(pattern_labels, in, text_size, BOB, chunk_size);
+  cout << "Match found?\t" << res.reveal<bool>() << endl;
+}
+
+
 int main(int argc, char** argv) {
 
   CommandLineArgumentProcessing::ProgramArgs args = CommandLineArgumentProcessing::parse_arguments(argc, argv);
@@ -392,7 +544,7 @@ int main(int argc, char** argv) {
   - Generates cryptographic keys (Delta value, PRG seeds) / Receives shared randomness
   - Initializes circuit execution engine / Initializes evaluation engine
   */
-	setup_semi_honest(io, party);
+	SemiHonestParty<NetIO> * ctx = setup_semi_honest(io, party, 1024*16, IKNP_OT, args.defer_inputs);
 
   cout << "Setup Runtime: " << emp::time_from(setup_runtime_start)/1000.0 << " ms" << endl;
   uint64_t setup_bytes_sent = io->counter - setup_initial_counter;
@@ -402,7 +554,7 @@ int main(int argc, char** argv) {
   string pattern {};
   string text {};
   int pattern_size {};
-  int text_size {};
+  int64_t text_size {};
 
   if (party == ALICE) {
     pattern = args.pattern;
@@ -412,18 +564,40 @@ int main(int argc, char** argv) {
   } else {
     text = args.text;
     text_size = text.size();
+    if (!args.text_file.empty()) {
+      ifstream in(args.text_file, ios::binary | ios::ate);
+      text_size = in ? (int64_t)in.tellg() : 0;
+    }
     pattern_size = args.pattern_length;
   }
 
+  // The mode must only depend on what both parties know: the public text
+  // length, the chunk size and the query options. Otherwise the parties run
+  // different circuits.
+  bool stream = text_size > args.chunk_size && args.mismatches == 0
+                && !args.wildcards && !args.count && !args.positions;
+  if (party == BOB && !args.text_file.empty() && !stream) {
+    ifstream in(args.text_file, ios::binary);
+    text.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+  }
+
   
   uint64_t online_initial_counter = io->counter;
   auto online_runtime_start = emp::clock_start();
 
-	test_matching(party, pattern, pattern_size, text, text_size);
+  if (args.regex)
+    test_matching_regex(party, pattern, text, text_size, args.states, args.alphabet);
+  else if (args.naive)
+    test_matching_naive(party, pattern, pattern_size, text, text_size);
+  else if (stream)
+    test_matching_stream(party, pattern, pattern_size, text, args.text_file, text_size, args.chunk_size);
+  else
+    test_matching(party, pattern, pattern_size, text, text_size, args);
   
   cout << "Online Runtime: " << emp::time_from(online_runtime_start)/1000.0 << " ms" << endl;
   uint64_t online_bytes_sent = io->counter - online_initial_counter;
   cout << "Online total bytes sent: " << online_bytes_sent << " bytes" << endl;
+  cout << "Per phase: " << ctx->stats().json() << endl;
 
 	cout << CircuitExecution::circ_exec->num_and()<<endl;
 	finalize_semi_honest();
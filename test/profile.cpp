@@ -0,0 +1,57 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+// Window scan of test/pattern_matching with every step in its own region
+Bit profiled_match(const SecretString & pattern, const SecretString & text) {
+	ProfileScope scope("find_match");
+	int m = pattern.size(), w = pattern.width;
+	vector<Bit> windows;
+	for(int pos = 0; pos + m <= text.size(); ++pos) {
+		vector<Bit> eq(w*m);
+		{
+			ProfileScope s("equality");
+			for(int i = 0; i < w*m; ++i)
+				eq[i] = !(pattern.bits[i] ^ text.bits[w*pos + i]);
+		}
+		ProfileScope s("window-AND");
+		windows.push_back(and_tree(eq));
+	}
+	ProfileScope s("OR-reduce");
+	return or_tree(windows);
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	setup_semi_honest(io, party);
+
+	string pattern = "GATTACA", text = "CATGATTACAGATTACCATGATTAGA";
+	uint64_t num_and = CircuitExecution::circ_exec->num_and();
+	Profiler prof("main");
+	SecretString p, t;
+	{
+		ProfileScope s("feed");
+		p = SecretString(pattern.size(), party == ALICE ? pattern : "", ALICE);
+		t = SecretString(text.size(), party == BOB ? text : "", BOB);
+	}
+	Bit res = profiled_match(p, t);
+	prof.stop();
+	num_and = CircuitExecution::circ_exec->num_and() - num_and;
+
+	if(!res.reveal<bool>(PUBLIC))
+		error("profiled match error!");
+	const Profiler::Node & root = prof.nodes[0];
+	if(root.total.num_and != num_and)
+		error("profiler lost AND gates!");
+	// all ANDs are in the three leaf regions, window by window
+	size_t windows = text.size() - pattern.size() + 1;
+	for(const auto & n : prof.nodes)
+		if(n.name == "window-AND" and (n.calls != windows or n.total.num_and != windows*(8*pattern.size() - 1)))
+			error("window-AND region error!");
+	cout << prof.report() << prof.folded(PROFILE_AND);
+
+	finalize_semi_honest();
+	delete io;
+}
@@ -0,0 +1,78 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+#include <regex>
+using namespace emp;
+using namespace std;
+
+const string dna = "ACGT";
+
+string random_dna(PRG & prg, int len) {
+	string s(len, 'A');
+	uint8_t * r = new uint8_t[len];
+	prg.random_data(r, len);
+	for(int i = 0; i < len; ++i)
+		s[i] = dna[r[i] % 4];
+	delete[] r;
+	return s;
+}
+
+// Both parties derive the same text, so match ends can be checked with std::regex
+void test_regex(int party, const string & re, int num_states, int text_len) {
+	PRG prg(fix_key);
+	string text = random_dna(prg, text_len);
+
+	uint64_t num_and = CircuitExecution::circ_exec->num_and();
+	SecretDfa dfa(num_states, party == ALICE ? re : "", ALICE, dna);
+	OneHotString text_labels(text_len, party == BOB ? text : "", BOB, dna);
+	vector<bool> res = reveal_batch(dfa_match_ends(dfa, text_labels));
+	num_and = CircuitExecution::circ_exec->num_and() - num_and;
+
+	std::regex plain(re);
+	for(int i = 0; i < text_len; ++i) {
+		bool expect = false;
+		for(int j = 0; j <= i and !expect; ++j)
+			expect = regex_match(text.substr(j, i - j + 1), plain);
+		if(res[i] != expect)
+			error("regex match error!");
+	}
+	cout << re << ", " << num_states << " states, " << text_len << " characters: "
+		<< num_and << " ANDs" << endl;
+}
+
+// A literal regex against the window scan of string_match.h on the same text
+void compare_windows(int party, const string & pattern, int text_len) {
+	PRG prg(fix_key);
+	string text = random_dna(prg, text_len);
+
+	uint64_t num_and = CircuitExecution::circ_exec->num_and();
+	SecretString p(pattern.size(), party == ALICE ? pattern : "", ALICE, dna);
+	SecretString t(text_len, party == BOB ? text : "", BOB, dna);
+	bool window = find_match(p, t).reveal<bool>();
+	uint64_t window_and = CircuitExecution::circ_exec->num_and() - num_and;
+
+	num_and = CircuitExecution::circ_exec->num_and();
+	// a literal is searched with |pattern|+1 states, as in KMP
+	SecretDfa dfa(pattern.size() + 1, party == ALICE ? pattern : "", ALICE, dna);
+	OneHotString text_labels(text_len, party == BOB ? text : "", BOB, dna);
+	bool scan = dfa_find_match(dfa, text_labels).reveal<bool>();
+	uint64_t regex_and = CircuitExecution::circ_exec->num_and() - num_and;
+
+	if(window != scan or window != (text.find(pattern) != string::npos))
+		error("regex and window scan disagree!");
+	cout << "literal " << pattern << ": windows " << window_and << " ANDs, DFA "
+		<< regex_and << " ANDs" << endl;
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	setup_semi_honest(io, party);
+	test_regex(party, "ACG", 4, 200);
+	test_regex(party, "A(C|G)+T", 8, 200);
+	test_regex(party, "[AC]G*T?A", 8, 200);
+	test_regex(party, "G.[^T]C", 16, 200);
+	compare_windows(party, "ACGTA", 1000);
+	compare_windows(party, "ACGTACGTAC", 1000);
+	finalize_semi_honest();
+	delete io;
+}
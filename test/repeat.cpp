@@ -29,8 +29,34 @@ void test_int_reveal(int number) {
 	done();
 }
 
+void test_session_reveal(SemiHonestSession<NetIO> & session, int number) {
+	session.reset();
+	Integer a(32, number, ALICE);
+	Integer b;
+	for(int i = 0; i < 1000; ++i)
+		b = Integer(32, number+1, BOB);
+	int32_t aa = a.reveal<int32_t>(PUBLIC);
+	int32_t bb = b.reveal<int32_t>(PUBLIC);
+
+	if(aa != number)error("session int a!\n");
+	if(bb != number+1) error("session int b!\n");
+}
+
 int main(int argc, char** argv) {
 	parse_party_and_port(argv, &party, &port);
+	auto start = clock_start();
 	for(int i = 0; i < 100; ++i)
 		test_int_reveal(1);
+	cout << "re-setup per job:\t"<<time_from(start)<<" us"<<endl;
+
+	usleep(100);
+	netio = new NetIO(party == ALICE ? nullptr : "127.0.0.1", port, true);
+	start = clock_start();
+	{
+		SemiHonestSession<NetIO> session(netio, party, 1024);
+		for(int i = 0; i < 100; ++i)
+			test_session_reveal(session, i);
+	}
+	cout << "session reset per job:\t"<<time_from(start)<<" us"<<endl;
+	delete netio;
 }
@@ -0,0 +1,51 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+const int num_session = 16;
+const int num_thread = 4;
+const int num_job = 10;
+
+// one client's jobs, run on whichever pool thread picks them up
+void serve(SemiHonestSession<NetIO> * session, int id) {
+	for(int job = 0; job < num_job; ++job) {
+		ExecutionScope scope(*session);
+		session->reset();
+		Integer a(32, id, ALICE);
+		Integer b(32, job, BOB);
+		if((a + b).reveal<int32_t>(PUBLIC) != id + job)
+			error("session error!");
+	}
+	session->io->flush();
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	vector<NetIO*> ios(num_session);
+	vector<SemiHonestSession<NetIO>*> sessions(num_session);
+	for(int i = 0; i < num_session; ++i) {
+		ios[i] = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port+i, true);
+		sessions[i] = new SemiHonestSession<NetIO>(ios[i], party, 1024);
+	}
+
+	auto start = clock_start();
+	{
+		ThreadPool pool(num_thread);
+		vector<future<void>> res;
+		for(int i = 0; i < num_session; ++i)
+			res.push_back(pool.enqueue([&sessions, i]() { serve(sessions[i], i); }));
+		for(auto & r : res)
+			r.get();
+	}
+	cout << num_session << " sessions on "<<num_thread<<" threads: "<<time_from(start)<<" us"<<endl;
+
+	for(int i = 0; i < num_session; ++i) {
+		SessionStats s = sessions[i]->stats();
+		if(i == 0)
+			cout << "session 0: "<<s.num_job<<" jobs, "<<s.bytes_sent<<" bytes sent on "
+				<<s.num_channel<<" channel(s), "<<s.memory<<" bytes buffered, "<<s.num_and<<" AND gates"<<endl;
+		delete sessions[i];
+		delete ios[i];
+	}
+}
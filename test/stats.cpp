@@ -0,0 +1,39 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+const int N = 1000;
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+
+	uint64_t start = io->counter;
+	SemiHonestParty<NetIO> * ctx = setup_semi_honest(io, party);
+	Integer x(32, 12345, ALICE), sum(32, 0, PUBLIC);
+	for(int i = 0; i < N; ++i)
+		sum = sum + (Integer(32, i, BOB) ^ x);
+	Bit larger = sum > x;
+	larger.reveal<bool>(PUBLIC);
+	uint64_t sent = io->counter - start;
+
+	PartyStats s = ctx->exchange_stats();
+	uint64_t total = 0;
+	for(int p = 0; p < NUM_PHASE; ++p) {
+		total += s.bytes_sent[p];
+		cout << PartyStats::phase_name(p) << ":\t" << s.bytes_sent[p] << " bytes sent, "
+			<< s.bytes_recv[p] << " received, " << s.time[p] << " us" << endl;
+	}
+	if(total != sent)
+		error("phases do not add up to the bytes sent!");
+	// two blocks per AND gate with half-gates, all from ALICE
+	uint64_t tables = party == ALICE ? s.bytes_sent[PHASE_GATES] : s.bytes_recv[PHASE_GATES];
+	if(tables != 32*s.num_and)
+		error("garbled tables not attributed to the gates phase!");
+	if(s.num_xor == 0 or s.num_refill == 0)
+		error("gate or refill counts missing!");
+
+	finalize_semi_honest(("stats_" + to_string(party) + ".json").c_str());
+	delete io;
+}
@@ -0,0 +1,90 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+// (x*y) ^ (x+y) and x < y, on two 32-bit Integers
+vector<Bit> kernel(const vector<Bit> & in) {
+	Integer x, y;
+	x.bits.assign(in.begin(), in.begin() + 32);
+	y.bits.assign(in.begin() + 32, in.end());
+	Integer z = (x * y) ^ (x + y);
+	vector<Bit> out = z.bits;
+	out.push_back(x < y);
+	return out;
+}
+
+void test_trace(int party, int runs = 1000) {
+	TracedCircuit ir = trace_circuit(64, kernel);
+	// both parties run from the same directory
+	string file = "trace_" + to_string(party) + ".bin";
+	ir.save(file);
+	TracedCircuit loaded(file);
+	CircuitReplay<NetIO> replay(&loaded);
+	TracedCircuit recycled = recycle_wires(loaded);
+	CircuitReplay<NetIO> recycled_replay(&recycled);
+
+	PRG prg(fix_key);
+	vector<int32_t> x(runs), y(runs);
+	prg.random_data(x.data(), runs*sizeof(int32_t));
+	prg.random_data(y.data(), runs*sizeof(int32_t));
+	vector<Integer> in;
+	for(int i = 0; i < runs; ++i) {
+		in.push_back(Integer(32, x[i], ALICE));
+		in.push_back(Integer(32, y[i], BOB));
+	}
+
+	auto start = clock_start();
+	vector<Bit> direct;
+	for(int i = 0; i < runs; ++i) {
+		vector<Bit> bits = in[2*i].bits;
+		bits.insert(bits.end(), in[2*i+1].bits.begin(), in[2*i+1].bits.end());
+		vector<Bit> out = kernel(bits);
+		direct.insert(direct.end(), out.begin(), out.end());
+	}
+	double direct_time = time_from(start);
+
+	start = clock_start();
+	vector<Bit> replayed(runs*loaded.outputs.size());
+	block label[64];
+	for(int i = 0; i < runs; ++i) {
+		memcpy(label, in[2*i].bits.data(), 32*sizeof(block));
+		memcpy(label + 32, in[2*i+1].bits.data(), 32*sizeof(block));
+		replay.compute((block *)replayed.data() + i*loaded.outputs.size(), label);
+	}
+	double replay_time = time_from(start);
+
+	vector<Bit> slotted(runs*recycled.outputs.size());
+	for(int i = 0; i < runs; ++i) {
+		memcpy(label, in[2*i].bits.data(), 32*sizeof(block));
+		memcpy(label + 32, in[2*i+1].bits.data(), 32*sizeof(block));
+		recycled_replay.compute((block *)slotted.data() + i*recycled.outputs.size(), label);
+	}
+
+	vector<bool> a = reveal_batch(direct), b = reveal_batch(replayed), c = reveal_batch(slotted);
+	for(int i = 0; i < runs; ++i) {
+		uint32_t z = (uint32_t)x[i]*(uint32_t)y[i] ^ ((uint32_t)x[i] + (uint32_t)y[i]);
+		for(int j = 0; j < 32; ++j)
+			if(b[33*i + j] != (bool)((z >> j) & 1))
+				error("replay error!");
+		if(b[33*i + 32] != (x[i] < y[i]))
+			error("replay compare error!");
+	}
+	if(a != b)
+		error("replay differs from direct execution!");
+	if(b != c)
+		error("replay with recycled wires differs!");
+	cout << loaded.gates.size() << " gates, " << loaded.num_and << " ANDs per run" << endl;
+	cout << loaded.num_wire << " wires, " << recycled.num_wire << " label slots" << endl;
+	cout << "direct:\t" << direct_time << " us" << endl;
+	cout << "replay:\t" << replay_time << " us" << endl;
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	setup_semi_honest(io, party);
+	test_trace(party);
+	finalize_semi_honest();
+	delete io;
+}